@@ -0,0 +1,171 @@
+#include "column_converter.hpp"
+#include "duckdb.hpp"
+#include <arrow/api.h>
+#include <arrow/util/byte_size.h>
+#include <benchmark/benchmark.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Measures the builder-mode conversion process() runs (ChunkAccumulator over
+// DuckDB DataChunks) per column type, vector encoding, null density and row
+// count. DuckDB produces the chunks once per case outside the timed loop, so
+// only the conversion is measured. Reports rows/s (items) and Arrow bytes/s.
+
+namespace {
+
+struct ColumnCase {
+    const char* name;
+    // SQL expression over `i`, the row number
+    const char* expression;
+};
+
+const ColumnCase kColumns[] = {
+    {"INTEGER", "i::INTEGER"},
+    {"BIGINT", "i::BIGINT"},
+    {"FLOAT", "i::FLOAT"},
+    {"DOUBLE", "i::DOUBLE / 7"},
+    // Up to 12 bytes a string_t is inlined, beyond that it points into the heap
+    {"VARCHAR_8", "lpad((i % 100000)::VARCHAR, 8, '0')"},
+    {"VARCHAR_64", "repeat('x', 56) || lpad((i % 100000)::VARCHAR, 8, '0')"},
+    {"DECIMAL", "(i / 100)::DECIMAL(18, 2)"},
+    {"TIMESTAMP", "TIMESTAMP '2024-01-01' + to_seconds(i)"},
+    {"LIST", "[i::INTEGER, (i + 1)::INTEGER, (i + 2)::INTEGER]"},
+    {"STRUCT", "{'id': i::INTEGER, 'name': 'n' || (i % 1000)::VARCHAR}"},
+};
+
+enum class Encoding { Flat, Constant, Dictionary };
+
+const char* EncodingName(Encoding encoding) {
+    switch (encoding) {
+        case Encoding::Flat:
+            return "flat";
+        case Encoding::Constant:
+            return "constant";
+        case Encoding::Dictionary:
+            return "dictionary";
+    }
+    return "";
+}
+
+// Distinct values a dictionary-encoded chunk selects from
+constexpr duckdb::idx_t kDictionarySize = 64;
+
+// One DuckDB result, fetched into chunks and re-encoded as requested
+struct Input {
+    duckdb::vector<duckdb::LogicalType> types;
+    duckdb::vector<std::string> names;
+    std::vector<std::unique_ptr<duckdb::DataChunk>> chunks;
+    int64_t rows = 0;
+};
+
+std::unique_ptr<Input> MakeInput(duckdb::Connection& conn, const ColumnCase& column, Encoding encoding,
+                                 int nullPercent, int64_t rows) {
+    std::string value = column.expression;
+    if (nullPercent > 0) {
+        value = "CASE WHEN hash(i) % 100 < " + std::to_string(nullPercent) + " THEN NULL ELSE " + value + " END";
+    }
+    auto result = conn.Query("SELECT " + value + " AS v FROM range(" + std::to_string(rows) + ") t(i)");
+    if (result->HasError()) {
+        std::cerr << "Failed to generate " << column.name << ": " << result->GetError() << std::endl;
+        return nullptr;
+    }
+
+    auto input = std::make_unique<Input>();
+    input->types = result->types;
+    input->names = result->names;
+    while (auto chunk = result->Fetch()) {
+        if (chunk->size() == 0) {
+            break;
+        }
+        input->rows += static_cast<int64_t>(chunk->size());
+        input->chunks.push_back(std::move(chunk));
+    }
+    if (input->chunks.empty() || encoding == Encoding::Flat) {
+        return input;
+    }
+
+    if (encoding == Encoding::Constant) {
+        auto constant = input->chunks[0]->GetValue(0, 0);
+        for (auto& chunk : input->chunks) {
+            chunk->data[0].Reference(constant);
+        }
+        return input;
+    }
+
+    // Every chunk selects from the first rows of the first one
+    duckdb::Vector dictionary(input->types[0]);
+    dictionary.Reference(input->chunks[0]->data[0]);
+    auto dictionarySize = std::min<duckdb::idx_t>(kDictionarySize, input->chunks[0]->size());
+    for (auto& chunk : input->chunks) {
+        duckdb::SelectionVector sel(chunk->size());
+        for (duckdb::idx_t row_idx = 0; row_idx < chunk->size(); ++row_idx) {
+            sel.set_index(row_idx, (row_idx * 7919) % dictionarySize);
+        }
+        chunk->data[0].Slice(dictionary, sel, chunk->size());
+    }
+    return input;
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> Convert(Input& input) {
+    ARROW_ASSIGN_OR_RAISE(auto accumulator, ChunkAccumulator::Make(input.types, input.names));
+    for (auto& chunk : input.chunks) {
+        ARROW_RETURN_NOT_OK(accumulator->append(*chunk));
+    }
+    return accumulator->finish();
+}
+
+void BM_Convert(benchmark::State& state, duckdb::Connection* conn, ColumnCase column, Encoding encoding,
+                int nullPercent) {
+    auto rows = state.range(0);
+    auto input = MakeInput(*conn, column, encoding, nullPercent, rows);
+    if (!input) {
+        state.SkipWithError("Failed to generate input");
+        return;
+    }
+
+    int64_t outputBytes = 0;
+    for (auto _ : state) {
+        auto table = Convert(*input);
+        if (!table.ok()) {
+            state.SkipWithError(table.status().ToString().c_str());
+            return;
+        }
+        outputBytes = arrow::util::TotalBufferSize(**table);
+        benchmark::DoNotOptimize(*table);
+    }
+    state.SetItemsProcessed(state.iterations() * input->rows);
+    state.SetBytesProcessed(state.iterations() * outputBytes);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    duckdb::DuckDB db(nullptr);
+    duckdb::Connection conn(db);
+
+    const Encoding encodings[] = {Encoding::Flat, Encoding::Constant, Encoding::Dictionary};
+    const int nullPercents[] = {0, 10, 50};
+    for (const auto& column : kColumns) {
+        for (auto encoding : encodings) {
+            for (auto nullPercent : nullPercents) {
+                auto name = std::string("Convert/") + column.name + "/" + EncodingName(encoding) +
+                            "/nulls:" + std::to_string(nullPercent);
+                benchmark::RegisterBenchmark(name.c_str(), BM_Convert, &conn, column, encoding, nullPercent)
+                    ->RangeMultiplier(8)
+                    ->Range(int64_t(1) << 16, int64_t(1) << 22)
+                    ->Unit(benchmark::kMillisecond);
+            }
+        }
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,132 @@
+#ifndef COLUMN_CONVERTER_HPP
+#define COLUMN_CONVERTER_HPP
+
+#include <string>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+#include "duckdb.hpp"
+#include "perf_counters.hpp"
+#include <arrow/api.h>
+
+
+// Maps a DuckDB column type to the Arrow type process() emits for it,
+// or nullptr when the converter does not support it. ENUMs map to utf8
+// here, which is what they become inside nested types.
+std::shared_ptr<arrow::DataType> ToArrowType(const duckdb::LogicalType& type);
+
+// Builds the Arrow schema for a query result, failing on unsupported columns.
+// Top-level ENUM columns, and the VARCHAR ones named in `dictionaryColumns`,
+// become dictionary<int32, utf8>.
+arrow::Result<std::shared_ptr<arrow::Schema>> ToArrowSchema(
+    const duckdb::vector<duckdb::LogicalType>& types, const duckdb::vector<std::string>& names,
+    const std::unordered_set<std::string>& dictionaryColumns = std::unordered_set<std::string>());
+
+// Appends `count` rows of a DuckDB vector to a builder created for its type
+arrow::Status AppendColumn(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count);
+
+// Target size of each Arrow chunk; 0 leaves that limit off. With no limit at
+// all every DuckDB DataChunk (STANDARD_VECTOR_SIZE rows) becomes one chunk.
+// DataChunks are split at a row target, so every chunk but the last has
+// exactly `rows` rows; a byte target is checked after each whole DataChunk
+struct BatchSize {
+    int64_t rows = 0;
+    int64_t bytes = 0;
+};
+
+// Collects converted DuckDB chunks into one arrow::ChunkedArray per column,
+// so every chunk of the result shares a single schema. Consecutive DataChunks
+// are coalesced into the same builders until the batch size is reached.
+// Dictionary columns keep their indices stable across batches. Each batch
+// only adds the values it saw first to the column's dictionary (for an ENUM,
+// the first batch adds all enum values), and a handed-out chunk shares the
+// dictionary as it stands then; finish() merges it once for all chunks.
+class ChunkAccumulator {
+public:
+    static arrow::Result<std::unique_ptr<ChunkAccumulator>> Make(
+        const duckdb::vector<duckdb::LogicalType>& types, const duckdb::vector<std::string>& names,
+        BatchSize batchSize = BatchSize(),
+        const std::unordered_set<std::string>& dictionaryColumns = std::unordered_set<std::string>(),
+        arrow::MemoryPool* pool = arrow::default_memory_pool());
+
+    // Convert columns concurrently on Arrow's CPU thread pool. DataChunks are
+    // held until a span of them is worth fanning out (16 DataChunks, the end
+    // of a row-bounded batch, or the point where a byte target may be
+    // reached), then each task converts one column across the whole span
+    void setParallel(bool enabled) { parallel = enabled; }
+    // Capacity hints, used before the first batch has been measured. With
+    // the total row count known, batches are reserved at exactly the rows
+    // still to come instead of growing; the payload estimate sizes the data
+    // buffer of a string column from the start.
+    void setExpectedRows(int64_t rows) { expectedRows = rows; }
+    void setExpectedBytesPerRow(int col_idx, double bytes) { bytesPerRow[col_idx] = bytes; }
+    // Count hardware events around every column's conversion, grouped by its
+    // DuckDB type id; nullptr (the default) turns that off
+    void setPerfProfile(PerfProfile* profile) { perfProfile = profile; }
+
+    arrow::Status append(duckdb::DataChunk& chunk);
+    // Finishes the batch in progress, even if it is below the batch size
+    arrow::Status flush();
+    // Hands out the oldest finished batch, or nullptr if there is none yet
+    arrow::Result<std::shared_ptr<arrow::RecordBatch>> takeBatch();
+    arrow::Result<std::shared_ptr<arrow::Table>> finish();
+
+    const std::shared_ptr<arrow::Schema>& schema() const { return outputSchema; }
+private:
+    // A DataChunk to convert, with what happens around it
+    struct PendingChunk {
+        duckdb::DataChunk* chunk = nullptr;
+        // Rows to reserve before it when it starts a batch, 0 otherwise
+        int64_t reserveRows = 0;
+        // Whether a batch is finished right after it
+        bool endsBatch = false;
+    };
+
+    ChunkAccumulator(std::shared_ptr<arrow::Schema> schema, BatchSize batchSize, arrow::MemoryPool* pool);
+    // Appends a chunk that fits in the current batch
+    arrow::Status appendRows(duckdb::DataChunk& chunk);
+    arrow::Status convert(const PendingChunk* span, size_t count);
+    arrow::Status convertPending();
+    // Finishes the batch once the converted rows reach the byte target
+    arrow::Status closeByteBatch();
+    int64_t batchReserveRows(int64_t chunkRows) const;
+    arrow::Status reserveColumn(int col_idx, int64_t rows);
+    int64_t batchBytes() const;
+    // Touches nothing but the column's own state, so tasks may run it concurrently
+    arrow::Status finishColumn(int col_idx);
+    // Folds the column's dictionary deltas into its dictionary
+    arrow::Status mergeDictionary(int col_idx);
+    // A finished chunk as handed out, with its dictionary if it has one
+    arrow::Result<std::shared_ptr<arrow::Array>> takeChunk(int col_idx, std::shared_ptr<arrow::Array> array);
+
+    std::shared_ptr<arrow::Schema> outputSchema;
+    BatchSize batchSize;
+    arrow::MemoryPool* pool;
+    bool parallel = false;
+    PerfProfile* perfProfile = nullptr;
+    // The key each column's counts are added under
+    std::vector<std::string> perfKeys;
+    // Rows of the whole result, or -1 if unknown
+    int64_t expectedRows = -1;
+    int64_t appendedRows = 0;
+    // Rows of the batch in progress, converted or still pending
+    int64_t batchRows = 0;
+    // Rows of the last finished batch, which sizes a byte-bounded one
+    int64_t lastBatchRows = 0;
+    // Average string payload per row of the last batch (or the hint), per
+    // column, used to size the data buffers of the next one
+    std::vector<double> bytesPerRow;
+    // Parallel mode: the span waiting to be converted, and references to the
+    // vectors of its chunks
+    std::vector<PendingChunk> pending;
+    std::vector<std::unique_ptr<duckdb::DataChunk>> pendingData;
+    int64_t pendingRows = 0;
+    std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders;
+    // Dictionary of each dictionary column so far, and the values finished
+    // batches have added since it was last merged
+    arrow::ArrayVector dictionaries;
+    std::vector<arrow::ArrayVector> dictionaryDeltas;
+    std::vector<arrow::ArrayVector> chunks;
+};
+
+#endif // COLUMN_CONVERTER_HPP
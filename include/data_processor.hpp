@@ -3,18 +3,164 @@
 
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "duckdb.hpp"
+#include "column_converter.hpp"
+#include "perf_counters.hpp"
+#include "recycling_memory_pool.hpp"
+#include "stage_stats.hpp"
 #include <arrow/api.h>
 
 
+// How process() turns DuckDB chunks into Arrow arrays
+enum class ExportMode {
+    Builder,        // walk every value and append it through arrow builders
+    CDataInterface  // DuckDB's ArrowConverter + arrow::ImportRecordBatch
+};
+
+// How loadParquet() exposes the file as `tmp`
+enum class LoadMode {
+    Table,  // copy the whole file into DuckDB's storage up front
+    View    // keep it a parquet_scan, so every query reads the file directly
+};
+
+enum class CompareOp {
+    Equal,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual
+};
+
+// A `column <op> value` filter on tmp. Predicates are ANDed together and
+// pushed into the scan, so Parquet row groups (or table segments) whose
+// min/max statistics cannot match are skipped without being decoded.
+struct Predicate {
+    std::string column;
+    CompareOp op;
+    duckdb::Value value;
+};
+
 class DataProcessor {
 public:
     DataProcessor();
+    ~DataProcessor();
     void loadParquet(const std::string& filepath);
+    // Loads every file (paths or globs such as data/*/*.parquet) as one tmp,
+    // scanned by DuckDB in parallel
+    void loadParquet(const std::vector<std::string>& filepaths);
+    // Must be set before loadParquet()
+    void setLoadMode(LoadMode mode);
+    // Surface key=value directories of the file paths as VARCHAR columns
+    void setHivePartitioning(bool enabled);
+    void setExportMode(ExportMode mode);
+    // Coalesce DuckDB chunks into Arrow chunks of this size (builder mode)
+    void setBatchSize(BatchSize size);
+    // Convert independent columns concurrently (builder mode)
+    void setParallelConversion(bool enabled);
+    // Fetch the next chunks on a separate thread while process() converts
+    void setPipelined(bool enabled);
+    // Emit a VARCHAR column of tmp as a dictionary array (builder mode) when
+    // every row group of the loaded Parquet files stores it with dictionary
+    // pages, as writers do for low-cardinality columns. ENUM columns always are
+    void setDictionaryEncoding(bool enabled);
+    // Emit exactly these VARCHAR columns as dictionary arrays instead, in any
+    // query; empty goes back to the Parquet encodings
+    void setDictionaryColumns(std::vector<std::string> columns);
+    // Pool for every buffer the builders allocate (builder mode; C data
+    // buffers stay owned by DuckDB). It must outlive the returned tables and
+    // batches. nullptr restores Arrow's default pool.
+    void setMemoryPool(arrow::MemoryPool* pool);
+    // Keep up to maxCachedBytes of freed builder buffers for the next
+    // process() or stream() instead of returning them to the memory pool;
+    // 0 turns recycling off. The arena sits in front of the current memory
+    // pool, and is rebuilt in front of any later one. Returned tables and
+    // batches keep it alive for as long as they hold its buffers.
+    void setBufferRecycling(int64_t maxCachedBytes);
+    // Columns process() reads from tmp, in this order; empty reads all of them
+    void setProjection(std::vector<std::string> columns);
+    void addPredicate(Predicate predicate);
+    void clearPredicates();
+    // The SELECT process() runs for the current projection and predicates
+    std::string scanQuery() const;
      std::shared_ptr<arrow::Table> process();
+    // Runs `query` as a streaming DuckDB query and converts one batch per
+    // ReadNext() call. The reader uses this processor's connection: it must
+    // not outlive it, and any other query on the processor invalidates it.
+    std::shared_ptr<arrow::RecordBatchReader> stream(const std::string& query);
+    // Exports the same stream through the Arrow C Stream Interface so other
+    // runtimes can consume it without an intermediate arrow::Table. The
+    // consumer owns `out` and must call its release callback; the lifetime
+    // rules of stream() apply until then. Returns false on failure.
+    bool exportStream(const std::string& query, ArrowArrayStream* out);
+    // Per-stage time, rows and bytes of the last loadParquet() and of the
+    // last process() or stream(); a stream's stages grow as it is read
+    const ProcessStats& processStats() const;
+    // Runs DuckDB's profiler (JSON output) on the query loadParquet() loads
+    // with and on the query behind process() or stream(). Their operator
+    // trees, with per-operator timings and cardinalities, are then returned
+    // by loadProfile() and queryProfile(). Set before loadParquet().
+    void setProfiling(bool enabled);
+    const std::string& loadProfile() const;
+    // Complete once process() returns, or once a stream has been read to the end
+    const std::string& queryProfile() const;
+    // Counts cycles, instructions, cache and branch misses and page faults
+    // around the conversion of each column (builder mode), grouped by DuckDB
+    // type id, or of each chunk in process() with the C Data Interface.
+    // Linux only; elsewhere, or where perf_event_open is refused, the counts
+    // stay zero. Reset by every process() and stream().
+    void setPerfCounters(bool enabled);
+    const PerfProfile& perfCounters() const;
 private:
+    arrow::MemoryPool* builderPool() const;
+    // Replaces the arena with one in front of memoryPool, if recycling
+    void resetRecyclingPool();
+    // Clears every stage but load at the start of process() and stream()
+    void resetCallStats();
+    void recordTableStats(const arrow::Table& table);
+    // Stores the profile of the connection's last query, if profiling
+    void captureProfile(std::string& profile);
+    // Reads row and column sizes from the Parquet footers of `files`
+    void loadParquetMetadata(const std::string& files);
+    // VARCHAR columns to emit as dictionary arrays
+    std::unordered_set<std::string> dictionaryColumnsFor(bool scansTmp) const;
+    // Reserves builder capacity from what is known about the result upfront
+    void hintCapacity(ChunkAccumulator& accumulator, duckdb::QueryResult& result, bool scansTmp) const;
+    std::shared_ptr<arrow::Table> processWithBuilders(duckdb::QueryResult& result);
+    std::shared_ptr<arrow::Table> processWithCDataInterface(duckdb::QueryResult& result);
+
     std::unique_ptr<duckdb::DuckDB> db;
     std::unique_ptr<duckdb::Connection> conn;
+    LoadMode loadMode = LoadMode::Table;
+    bool hivePartitioning = false;
+    ExportMode exportMode = ExportMode::Builder;
+    BatchSize batchSize;
+    bool parallelConversion = false;
+    bool pipelined = false;
+    bool dictionaryEncoding = false;
+    std::vector<std::string> dictionaryColumns;
+    arrow::MemoryPool* memoryPool = arrow::default_memory_pool();
+    int64_t recycledBytesLimit = 0;
+    std::shared_ptr<RecyclingMemoryPool> recyclingPool;
+    std::vector<std::string> projection;
+    std::vector<Predicate> predicates;
+    // Rows and uncompressed bytes per column of the loaded Parquet files,
+    // -1 and empty when the footers could not be read
+    int64_t parquetRows = -1;
+    std::unordered_map<std::string, int64_t> parquetColumnBytes;
+    // Columns stored with dictionary pages in every row group
+    std::unordered_set<std::string> parquetDictionaryColumns;
+    ProcessStats stats;
+    bool profiling = false;
+    std::string loadProfileJson;
+    std::string queryProfileJson;
+    // Where DuckDB writes its profiles, unique to this processor; removed
+    // with it
+    std::string profileScratch;
+    bool perfCountersEnabled = false;
+    PerfProfile perfProfile;
 };
 
 #endif // DATA_PROCESSOR_HPP
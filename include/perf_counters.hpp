@@ -0,0 +1,84 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+// Hardware and software event counts of a piece of work, from
+// perf_event_open. Only user-space events are counted, so the counters also
+// open with the default perf_event_paranoid setting.
+struct PerfCounts {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t cacheMisses = 0;
+    uint64_t branchMisses = 0;
+    uint64_t pageFaults = 0;
+    int64_t rows = 0;
+
+    PerfCounts& operator+=(const PerfCounts& other);
+};
+
+// Running counters of the calling thread. The hardware events form one group
+// and are read with a single syscall. On other platforms, or where the kernel
+// refuses them (containers, VMs without a PMU), available() is false and
+// read() returns zeros.
+class ThreadPerfCounters {
+public:
+    // The calling thread's counters, opened on its first call
+    static ThreadPerfCounters& current();
+    ~ThreadPerfCounters();
+
+    ThreadPerfCounters(const ThreadPerfCounters&) = delete;
+    ThreadPerfCounters& operator=(const ThreadPerfCounters&) = delete;
+
+    bool available() const;
+    PerfCounts read() const;
+private:
+    ThreadPerfCounters();
+
+    // Cycles (the group leader), instructions, cache and branch misses;
+    // empty if the group could not be opened in full
+    std::vector<int> hardwareFds;
+    int pageFaultFd = -1;
+};
+
+// Counter totals per key (a column type). Scopes on several threads may add
+// to it at once.
+class PerfProfile {
+public:
+    void add(const std::string& key, const PerfCounts& counts);
+    void reset();
+    std::map<std::string, PerfCounts> totals() const;
+    // {"<key>": {"cycles": ..., "ipc": ..., ...}, ...}, with per-row rates
+    std::string toJson() const;
+private:
+    mutable std::mutex mutex;
+    std::map<std::string, PerfCounts> counts;
+};
+
+// Adds the calling thread's events from construction until stop() (or
+// destruction) to `profile` under `key`. A null profile measures nothing.
+class PerfScope {
+public:
+    PerfScope(PerfProfile* profile, const std::string& key, int64_t rows);
+    ~PerfScope() { stop(); }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+    void stop();
+private:
+    PerfProfile* profile;
+    std::string key;
+    int64_t rows;
+    PerfCounts start;
+};
+
+// Whether this thread could open any counter
+bool PerfCountersAvailable();
+
+#endif // PERF_COUNTERS_HPP
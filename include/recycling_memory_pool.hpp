@@ -0,0 +1,78 @@
+#ifndef RECYCLING_MEMORY_POOL_HPP
+#define RECYCLING_MEMORY_POOL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <arrow/memory_pool.h>
+#include <arrow/status.h>
+#include <arrow/type_fwd.h>
+
+
+// Arena in front of another arrow::MemoryPool for workloads that build
+// similar-sized results over and over. Sizes are rounded up to power-of-two
+// classes, and freed buffers are kept on a free list per class (up to
+// maxCachedBytes in total) to be handed out again, so a steady stream of
+// process() calls stops reaching malloc and faulting in fresh pages. Growth
+// within a class is free, since the buffer already has the room.
+class RecyclingMemoryPool : public arrow::MemoryPool {
+public:
+    RecyclingMemoryPool(arrow::MemoryPool* target, int64_t maxCachedBytes);
+    ~RecyclingMemoryPool() override;
+
+    RecyclingMemoryPool(const RecyclingMemoryPool&) = delete;
+    RecyclingMemoryPool& operator=(const RecyclingMemoryPool&) = delete;
+
+    using arrow::MemoryPool::Allocate;
+    using arrow::MemoryPool::Reallocate;
+    using arrow::MemoryPool::Free;
+
+    arrow::Status Allocate(int64_t size, int64_t alignment, uint8_t** out) override;
+    arrow::Status Reallocate(int64_t oldSize, int64_t newSize, int64_t alignment, uint8_t** ptr) override;
+    void Free(uint8_t* buffer, int64_t size, int64_t alignment) override;
+    // Returns every cached buffer to the target pool
+    void ReleaseUnused() override;
+
+    int64_t bytes_allocated() const override { return liveBytes.load(); }
+    int64_t max_memory() const override { return peakBytes.load(); }
+    int64_t total_bytes_allocated() const override { return totalBytes.load(); }
+    int64_t num_allocations() const override { return allocations.load(); }
+    std::string backend_name() const override { return target->backend_name(); }
+
+    // Buffers freed beyond the limit go straight back to the target pool
+    void setMaxCachedBytes(int64_t bytes);
+    // Allocations served from the free lists rather than the target pool
+    int64_t reusedAllocations() const { return reused.load(); }
+    int64_t cachedBytes() const;
+private:
+    static int SizeClass(int64_t size);
+    static bool Recyclable(int64_t size, int64_t alignment);
+
+    arrow::MemoryPool* target;
+    int64_t maxCachedBytes;
+
+    mutable std::mutex mutex;
+    // freeLists[c] holds buffers of 1 << c bytes
+    std::vector<std::vector<uint8_t*>> freeLists;
+    int64_t cached = 0;
+
+    std::atomic<int64_t> liveBytes{0};
+    std::atomic<int64_t> peakBytes{0};
+    std::atomic<int64_t> totalBytes{0};
+    std::atomic<int64_t> allocations{0};
+    std::atomic<int64_t> reused{0};
+};
+
+// Tables and batches built from an arena can outlive whoever set it up, and
+// their buffers are still freed through it. These rewrap every buffer
+// (children and dictionaries included) so that each one holds a reference to
+// the arena, which then lives until the last of them is freed.
+std::shared_ptr<arrow::Table> RetainArena(const std::shared_ptr<arrow::Table>& table,
+                                          const std::shared_ptr<RecyclingMemoryPool>& arena);
+std::shared_ptr<arrow::RecordBatch> RetainArena(const std::shared_ptr<arrow::RecordBatch>& batch,
+                                                const std::shared_ptr<RecyclingMemoryPool>& arena);
+
+#endif // RECYCLING_MEMORY_POOL_HPP
@@ -0,0 +1,48 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+
+// Bounded single-producer/single-consumer ring buffer. Each side only ever
+// writes its own index, so push() and pop() need no lock; a full or empty
+// queue is waited out by yielding the thread.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) : slots(capacity + 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    void push(T value) {
+        auto tail = tailIndex.load(std::memory_order_relaxed);
+        auto next = (tail + 1) % slots.size();
+        while (next == headIndex.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        slots[tail] = std::move(value);
+        tailIndex.store(next, std::memory_order_release);
+    }
+
+    T pop() {
+        auto head = headIndex.load(std::memory_order_relaxed);
+        while (head == tailIndex.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        T value = std::move(slots[head]);
+        headIndex.store((head + 1) % slots.size(), std::memory_order_release);
+        return value;
+    }
+
+private:
+    std::vector<T> slots;
+    // Kept on separate cache lines so producer and consumer do not false-share
+    alignas(64) std::atomic<size_t> headIndex{0};
+    alignas(64) std::atomic<size_t> tailIndex{0};
+};
+
+#endif // SPSC_QUEUE_HPP
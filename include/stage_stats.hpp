@@ -0,0 +1,54 @@
+#ifndef STAGE_STATS_HPP
+#define STAGE_STATS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+
+// Time and volume of one stage of a DataProcessor call. CPU time is the
+// process's, so it includes DuckDB's worker threads; in pipelined mode fetch
+// and convert overlap, and their wall times add up to more than the call.
+struct StageStats {
+    double wallSeconds = 0.0;
+    double cpuSeconds = 0.0;
+    int64_t rows = 0;
+    int64_t bytes = 0;
+};
+
+// Breakdown of the last loadParquet() and the last process() or stream()
+struct ProcessStats {
+    // loadParquet(): CREATE TABLE/VIEW over parquet_scan plus the footer read.
+    // Rows and bytes are the Parquet row count and uncompressed size
+    StageStats load;
+    // Query()/SendQuery(). For a materialized result this is where the scan
+    // and Parquet decoding happen
+    StageStats query;
+    // FetchRaw() of every DataChunk
+    StageStats fetch;
+    // DataChunks to Arrow, builders or C Data Interface; bytes are Arrow buffers
+    StageStats convert;
+    // Table::Make / FromRecordBatches (process() only)
+    StageStats assemble;
+
+    std::string toJson() const;
+};
+
+// Adds the wall and process CPU time from construction until stop() (or
+// destruction) to a stage
+class StageTimer {
+public:
+    explicit StageTimer(StageStats& stage);
+    ~StageTimer() { stop(); }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    void stop();
+private:
+    StageStats* stage;
+    std::chrono::steady_clock::time_point wallStart;
+    double cpuStart;
+};
+
+#endif // STAGE_STATS_HPP
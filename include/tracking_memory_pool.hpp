@@ -0,0 +1,62 @@
+#ifndef TRACKING_MEMORY_POOL_HPP
+#define TRACKING_MEMORY_POOL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <arrow/memory_pool.h>
+#include <arrow/status.h>
+
+
+// What went through a TrackingMemoryPool since its last reset()
+struct MemoryStats {
+    int64_t bytesAllocated = 0;  // Sum of all allocations and reallocation growth
+    int64_t peakBytes = 0;       // High-water mark of live bytes
+    int64_t liveBytes = 0;       // Still held, e.g. by a returned arrow::Table
+    int64_t allocations = 0;
+    int64_t reallocations = 0;
+    int64_t frees = 0;
+};
+
+// Forwards to another arrow::MemoryPool (system, jemalloc or mimalloc) and
+// counts what passes through it, so allocators can be compared on the same
+// workload. reset() starts a new window, e.g. one per process() call. With a
+// limit set, allocations that would exceed it fail with OutOfMemory.
+class TrackingMemoryPool : public arrow::MemoryPool {
+public:
+    explicit TrackingMemoryPool(arrow::MemoryPool* target = arrow::default_memory_pool());
+
+    using arrow::MemoryPool::Allocate;
+    using arrow::MemoryPool::Reallocate;
+    using arrow::MemoryPool::Free;
+
+    arrow::Status Allocate(int64_t size, int64_t alignment, uint8_t** out) override;
+    arrow::Status Reallocate(int64_t oldSize, int64_t newSize, int64_t alignment, uint8_t** ptr) override;
+    void Free(uint8_t* buffer, int64_t size, int64_t alignment) override;
+    void ReleaseUnused() override { target->ReleaseUnused(); }
+
+    int64_t bytes_allocated() const override { return liveBytes.load(); }
+    int64_t max_memory() const override { return peakBytes.load(); }
+    int64_t total_bytes_allocated() const override { return totalBytes.load(); }
+    int64_t num_allocations() const override { return allocations.load(); }
+    std::string backend_name() const override { return target->backend_name(); }
+
+    // Caps the live bytes of this pool; 0 removes the cap
+    void setLimit(int64_t bytes) { limit = bytes; }
+    // Clears the counters; the bytes still live become the new peak
+    void reset();
+    MemoryStats stats() const;
+private:
+    arrow::Status grow(int64_t bytes);
+
+    arrow::MemoryPool* target;
+    std::atomic<int64_t> limit{0};
+    std::atomic<int64_t> liveBytes{0};
+    std::atomic<int64_t> peakBytes{0};
+    std::atomic<int64_t> totalBytes{0};
+    std::atomic<int64_t> allocations{0};
+    std::atomic<int64_t> reallocations{0};
+    std::atomic<int64_t> frees{0};
+};
+
+#endif // TRACKING_MEMORY_POOL_HPP
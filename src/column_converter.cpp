@@ -0,0 +1,1174 @@
+#include "column_converter.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include <arrow/util/parallel.h>
+
+
+namespace {
+
+// Most rows reserved up front for a byte-bounded batch before one has been
+// measured
+constexpr int64_t kMaxGuessedBatchRows = 64 * STANDARD_VECTOR_SIZE;
+
+// Rows of DataChunks the parallel mode collects before fanning columns out,
+// so the thread pool is scheduled once per span rather than per DataChunk
+constexpr int64_t kParallelSpanRows = 16 * STANDARD_VECTOR_SIZE;
+
+// True when no row of the chunk needs a null check. A validity mask can be
+// allocated without any bit cleared, so flat masks are also scanned word-wise
+bool AllRowsValid(const duckdb::UnifiedVectorFormat& format, duckdb::idx_t count) {
+    return format.validity.AllValid() || (!format.sel->data() && format.validity.CheckAllValid(count));
+}
+
+// Expands the validity of `count` flat rows into Arrow's one-byte-per-row
+// form, 64 rows per mask word, for builders without a bitmap overload
+void ExpandValidity(const duckdb::ValidityMask& validity, duckdb::idx_t count, uint8_t* out) {
+    auto entries = validity.GetData();
+    for (duckdb::idx_t base = 0; base < count; base += duckdb::ValidityMask::BITS_PER_VALUE) {
+        auto rows = std::min<duckdb::idx_t>(duckdb::ValidityMask::BITS_PER_VALUE, count - base);
+        auto entry = entries[base / duckdb::ValidityMask::BITS_PER_VALUE];
+        if (duckdb::ValidityMask::AllValid(entry)) {
+            std::memset(out + base, 1, rows);
+        } else if (duckdb::ValidityMask::NoneValid(entry)) {
+            std::memset(out + base, 0, rows);
+        } else {
+            for (duckdb::idx_t i = 0; i < rows; ++i) {
+                out[base + i] = static_cast<uint8_t>((entry >> i) & 1);
+            }
+        }
+    }
+}
+
+const uint8_t* ValidBytesOrNull(const std::vector<uint8_t>& validBytes) {
+    return validBytes.empty() ? nullptr : validBytes.data();
+}
+
+std::vector<uint8_t> CollectValidBytes(const duckdb::UnifiedVectorFormat& format, duckdb::idx_t count) {
+    std::vector<uint8_t> validBytes;
+    if (AllRowsValid(format, count)) {
+        return validBytes;
+    }
+    validBytes.resize(count);
+    if (!format.sel->data()) {
+        ExpandValidity(format.validity, count, validBytes.data());
+        return validBytes;
+    }
+    for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+        validBytes[row_idx] = format.validity.RowIsValid(format.sel->get_index(row_idx));
+    }
+    return validBytes;
+}
+
+// Bulk-append a flat fixed-width vector: the physical data is handed to Arrow
+// in one call. DuckDB's validity mask keeps row i in bit i of little-endian
+// 64-bit words, which is byte for byte Arrow's validity bitmap, so it is
+// copied wholesale; without nulls no bitmap is read at all
+template <typename BuilderType, typename T>
+arrow::Status AppendFlatVector(BuilderType& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    auto data = duckdb::FlatVector::GetData<T>(vector);
+    auto& validity = duckdb::FlatVector::Validity(vector);
+    if (validity.AllValid() || validity.CheckAllValid(count)) {
+        return builder.AppendValues(data, static_cast<int64_t>(count));
+    }
+
+    if constexpr (std::is_same_v<BuilderType, arrow::BooleanBuilder>) {
+        // BooleanBuilder only takes a bitmap alongside bit-packed values
+        std::vector<uint8_t> valid_bytes(count);
+        ExpandValidity(validity, count, valid_bytes.data());
+        return builder.AppendValues(data, static_cast<int64_t>(count), valid_bytes.data());
+    } else {
+        auto bitmap = reinterpret_cast<const uint8_t*>(validity.GetData());
+        return builder.AppendValues(data, static_cast<int64_t>(count), bitmap, 0);
+    }
+}
+
+// A constant vector holds a single value for the whole chunk: broadcast it
+// with one fill instead of reading it back once per row
+template <typename BuilderType, typename T>
+arrow::Status AppendConstantVector(BuilderType& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    if (duckdb::ConstantVector::IsNull(vector)) {
+        return builder.AppendNulls(static_cast<int64_t>(count));
+    }
+
+    auto value = *duckdb::ConstantVector::GetData<T>(vector);
+    if constexpr (std::is_same_v<BuilderType, arrow::BooleanBuilder>) {
+        return builder.AppendValues(static_cast<int64_t>(count), value != 0);
+    } else {
+        auto offset = builder.length();
+        ARROW_RETURN_NOT_OK(builder.AppendEmptyValues(static_cast<int64_t>(count)));
+        std::fill_n(builder.GetMutableValue(offset), count, value);
+        return arrow::Status::OK();
+    }
+}
+
+// Dictionary (and any other compressed) vectors are gathered through their
+// selection vector straight from the child's physical data
+template <typename BuilderType, typename T>
+arrow::Status AppendUnifiedVector(BuilderType& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    duckdb::UnifiedVectorFormat format;
+    vector.ToUnifiedFormat(count, format);
+    auto data = duckdb::UnifiedVectorFormat::GetData<T>(format);
+
+    ARROW_RETURN_NOT_OK(builder.Reserve(static_cast<int64_t>(count)));
+    for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+        auto idx = format.sel->get_index(row_idx);
+        if (format.validity.RowIsValid(idx)) {
+            builder.UnsafeAppend(data[idx]);
+        } else {
+            builder.UnsafeAppendNull();
+        }
+    }
+    return arrow::Status::OK();
+}
+
+template <typename BuilderType, typename T>
+arrow::Status AppendVector(BuilderType& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    switch (vector.GetVectorType()) {
+        case duckdb::VectorType::FLAT_VECTOR:
+            return AppendFlatVector<BuilderType, T>(builder, vector, count);
+        case duckdb::VectorType::CONSTANT_VECTOR:
+            return AppendConstantVector<BuilderType, T>(builder, vector, count);
+        default:
+            return AppendUnifiedVector<BuilderType, T>(builder, vector, count);
+    }
+}
+
+// Types whose DuckDB and Arrow layouts differ (decimals, UUIDs, intervals)
+// are rewritten into one contiguous buffer per chunk, then appended in bulk
+template <typename BuilderType, typename SRC, typename DST, typename OP>
+arrow::Status AppendTransformedVector(BuilderType& builder, duckdb::Vector& vector, duckdb::idx_t count, OP op) {
+    duckdb::UnifiedVectorFormat format;
+    vector.ToUnifiedFormat(count, format);
+    auto data = duckdb::UnifiedVectorFormat::GetData<SRC>(format);
+
+    // Null slots are transformed too: the ops are plain arithmetic and a
+    // branch-free loop beats skipping them
+    std::vector<DST> values(count);
+    for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+        values[row_idx] = op(data[format.sel->get_index(row_idx)]);
+    }
+
+    auto validBytes = CollectValidBytes(format, count);
+    auto valid = ValidBytesOrNull(validBytes);
+    if constexpr (std::is_base_of_v<arrow::FixedSizeBinaryBuilder, BuilderType>) {
+        return builder.AppendValues(reinterpret_cast<const uint8_t*>(values.data()), static_cast<int64_t>(count), valid);
+    } else {
+        return builder.AppendValues(values.data(), static_cast<int64_t>(count), valid);
+    }
+}
+
+// VARCHAR and BLOB payloads are copied straight out of their string_t
+// (inlined for short strings, a pointer into DuckDB's heap otherwise). The
+// total payload of the chunk is summed first, so offsets and data are each
+// reserved once and then written in a single pass without any regrowth.
+template <typename BuilderType>
+arrow::Status AppendStringTVector(BuilderType& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    if (vector.GetVectorType() == duckdb::VectorType::CONSTANT_VECTOR) {
+        if (duckdb::ConstantVector::IsNull(vector)) {
+            return builder.AppendNulls(static_cast<int64_t>(count));
+        }
+
+        auto value = *duckdb::ConstantVector::GetData<duckdb::string_t>(vector);
+        ARROW_RETURN_NOT_OK(builder.Reserve(static_cast<int64_t>(count)));
+        ARROW_RETURN_NOT_OK(builder.ReserveData(static_cast<int64_t>(value.GetSize() * count)));
+        for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+            builder.UnsafeAppend(value.GetData(), static_cast<int32_t>(value.GetSize()));
+        }
+        return arrow::Status::OK();
+    }
+
+    duckdb::UnifiedVectorFormat format;
+    vector.ToUnifiedFormat(count, format);
+    auto data = duckdb::UnifiedVectorFormat::GetData<duckdb::string_t>(format);
+    auto all_valid = AllRowsValid(format, count);
+
+    int64_t total_length = 0;
+    for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+        auto idx = format.sel->get_index(row_idx);
+        if (all_valid || format.validity.RowIsValid(idx)) {
+            total_length += static_cast<int64_t>(data[idx].GetSize());
+        }
+    }
+
+    ARROW_RETURN_NOT_OK(builder.Reserve(static_cast<int64_t>(count)));
+    ARROW_RETURN_NOT_OK(builder.ReserveData(total_length));
+    for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+        auto idx = format.sel->get_index(row_idx);
+        if (all_valid || format.validity.RowIsValid(idx)) {
+            builder.UnsafeAppend(data[idx].GetData(), static_cast<int32_t>(data[idx].GetSize()));
+        } else {
+            builder.UnsafeAppendNull();
+        }
+    }
+    return arrow::Status::OK();
+}
+
+// Arrow's Decimal128 is a little-endian two's complement 128-bit integer,
+// which is exactly the layout of duckdb::hugeint_t
+template <typename T>
+duckdb::hugeint_t WidenToHugeint(T value) {
+    duckdb::hugeint_t result;
+    result.lower = static_cast<uint64_t>(static_cast<int64_t>(value));
+    result.upper = value < 0 ? -1 : 0;
+    return result;
+}
+
+duckdb::hugeint_t IdentityHugeint(duckdb::hugeint_t value) {
+    return value;
+}
+
+// DuckDB stores a UUID as a hugeint with the top bit flipped (so it sorts
+// correctly); Arrow wants the 16 bytes in canonical big-endian order
+std::array<uint8_t, 16> UuidToBytes(duckdb::hugeint_t value) {
+    std::array<uint8_t, 16> bytes;
+    auto upper = static_cast<uint64_t>(value.upper) ^ (uint64_t(1) << 63);
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<uint8_t>(upper >> (56 - 8 * i));
+        bytes[8 + i] = static_cast<uint8_t>(value.lower >> (56 - 8 * i));
+    }
+    return bytes;
+}
+
+arrow::MonthDayNanoIntervalType::MonthDayNanos IntervalToMonthDayNanos(duckdb::interval_t value) {
+    return {value.months, value.days, value.micros * 1000};
+}
+
+// Appends the rows of `child` picked by `sel` in one go; a selection without
+// data is the identity, so the child keeps its flat bulk path
+arrow::Status AppendSelectedRows(arrow::ArrayBuilder& builder, duckdb::Vector& child, const duckdb::SelectionVector& sel,
+                                 duckdb::idx_t count) {
+    if (count == 0) {
+        return arrow::Status::OK();
+    }
+    if (!sel.data()) {
+        return AppendColumn(builder, child, count);
+    }
+    duckdb::Vector selected(child, sel, count);
+    return AppendColumn(builder, selected, count);
+}
+
+// Offsets, validity and child rows of a chunk of LIST (or MAP) rows. When
+// the lists sit back to back in the child vector, which is the usual case
+// for scans, the child is appended as a single slice.
+struct ListRows {
+    std::vector<int32_t> offsets;
+    std::vector<uint8_t> validBytes;  // empty when every row is valid
+    bool contiguous = true;
+    duckdb::idx_t childStart = 0;
+    duckdb::idx_t childCount = 0;
+    duckdb::SelectionVector childSel;
+};
+
+arrow::Result<ListRows> CollectListRows(duckdb::Vector& vector, duckdb::idx_t count, int64_t childBase) {
+    duckdb::UnifiedVectorFormat format;
+    vector.ToUnifiedFormat(count, format);
+    auto entries = duckdb::UnifiedVectorFormat::GetData<duckdb::list_entry_t>(format);
+
+    ListRows rows;
+    rows.offsets.resize(count);
+    if (!format.validity.AllValid()) {
+        rows.validBytes.resize(count);
+    }
+
+    bool started = false;
+    for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+        auto idx = format.sel->get_index(row_idx);
+        auto valid = format.validity.RowIsValid(idx);
+        if (!rows.validBytes.empty()) {
+            rows.validBytes[row_idx] = valid;
+        }
+
+        if (childBase + static_cast<int64_t>(rows.childCount) > std::numeric_limits<int32_t>::max()) {
+            return arrow::Status::CapacityError("List child exceeds 32-bit offsets");
+        }
+        rows.offsets[row_idx] = static_cast<int32_t>(childBase + rows.childCount);
+        if (!valid || entries[idx].length == 0) {
+            continue;
+        }
+        if (!started) {
+            rows.childStart = entries[idx].offset;
+            started = true;
+        } else if (entries[idx].offset != rows.childStart + rows.childCount) {
+            rows.contiguous = false;
+        }
+        rows.childCount += entries[idx].length;
+    }
+
+    if (!rows.contiguous) {
+        rows.childSel.Initialize(rows.childCount);
+        duckdb::idx_t child_idx = 0;
+        for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+            auto idx = format.sel->get_index(row_idx);
+            if (!format.validity.RowIsValid(idx)) {
+                continue;
+            }
+            for (duckdb::idx_t i = 0; i < entries[idx].length; ++i) {
+                rows.childSel.set_index(child_idx++, entries[idx].offset + i);
+            }
+        }
+    }
+    return rows;
+}
+
+arrow::Status AppendListChild(arrow::ArrayBuilder& builder, duckdb::Vector& child, const ListRows& rows) {
+    if (rows.childCount == 0) {
+        return arrow::Status::OK();
+    }
+    if (rows.contiguous) {
+        duckdb::Vector slice(child, rows.childStart, rows.childStart + rows.childCount);
+        return AppendColumn(builder, slice, rows.childCount);
+    }
+    return AppendSelectedRows(builder, child, rows.childSel, rows.childCount);
+}
+
+arrow::Status AppendList(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    auto& list_builder = static_cast<arrow::ListBuilder&>(builder);
+    ARROW_ASSIGN_OR_RAISE(auto rows, CollectListRows(vector, count, list_builder.value_builder()->length()));
+    ARROW_RETURN_NOT_OK(list_builder.AppendValues(rows.offsets.data(), static_cast<int64_t>(count),
+                                                  ValidBytesOrNull(rows.validBytes)));
+    return AppendListChild(*list_builder.value_builder(), duckdb::ListVector::GetEntry(vector), rows);
+}
+
+// A DuckDB MAP is a LIST of STRUCT(key, value); keys and values go to the
+// MapBuilder's key and item builders with the same child rows
+arrow::Status AppendMap(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    auto& map_builder = static_cast<arrow::MapBuilder&>(builder);
+    ARROW_ASSIGN_OR_RAISE(auto rows, CollectListRows(vector, count, map_builder.key_builder()->length()));
+    ARROW_RETURN_NOT_OK(map_builder.AppendValues(rows.offsets.data(), static_cast<int64_t>(count),
+                                                 ValidBytesOrNull(rows.validBytes)));
+    ARROW_RETURN_NOT_OK(AppendListChild(*map_builder.key_builder(), duckdb::MapVector::GetKeys(vector), rows));
+    return AppendListChild(*map_builder.item_builder(), duckdb::MapVector::GetValues(vector), rows);
+}
+
+// ARRAY rows own `size` consecutive child slots each, null or not
+arrow::Status AppendArray(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    auto& array_builder = static_cast<arrow::FixedSizeListBuilder&>(builder);
+    auto size = duckdb::ArrayType::GetSize(vector.GetType());
+
+    duckdb::UnifiedVectorFormat format;
+    vector.ToUnifiedFormat(count, format);
+    auto validBytes = CollectValidBytes(format, count);
+    ARROW_RETURN_NOT_OK(array_builder.AppendValues(static_cast<int64_t>(count), ValidBytesOrNull(validBytes)));
+
+    auto& child = duckdb::ArrayVector::GetEntry(vector);
+    if (!format.sel->data()) {
+        return AppendColumn(*array_builder.value_builder(), child, count * size);
+    }
+    duckdb::SelectionVector childSel(count * size);
+    for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+        auto idx = format.sel->get_index(row_idx);
+        for (duckdb::idx_t i = 0; i < size; ++i) {
+            childSel.set_index(row_idx * size + i, idx * size + i);
+        }
+    }
+    return AppendSelectedRows(*array_builder.value_builder(), child, childSel, count * size);
+}
+
+// STRUCT children are row-aligned with their parent, so each field is
+// appended as a whole column
+arrow::Status AppendStruct(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    auto& struct_builder = static_cast<arrow::StructBuilder&>(builder);
+
+    duckdb::UnifiedVectorFormat format;
+    vector.ToUnifiedFormat(count, format);
+    auto validBytes = CollectValidBytes(format, count);
+    ARROW_RETURN_NOT_OK(struct_builder.AppendValues(static_cast<int64_t>(count), ValidBytesOrNull(validBytes)));
+
+    auto& entries = duckdb::StructVector::GetEntries(vector);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        ARROW_RETURN_NOT_OK(AppendSelectedRows(*struct_builder.field_builder(static_cast<int>(i)), *entries[i],
+                                               *format.sel, count));
+    }
+    return arrow::Status::OK();
+}
+
+// DuckDB stores a UNION like a sparse union: a tag per row plus one
+// row-aligned vector per member, all of which map onto a SparseUnionBuilder
+arrow::Status AppendUnion(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    auto& union_builder = static_cast<arrow::SparseUnionBuilder&>(builder);
+
+    duckdb::UnifiedVectorFormat format;
+    vector.ToUnifiedFormat(count, format);
+    duckdb::UnifiedVectorFormat tag_format;
+    auto& tags = duckdb::UnionVector::GetTags(vector);
+    tags.ToUnifiedFormat(count, tag_format);
+    auto tag_data = duckdb::UnifiedVectorFormat::GetData<duckdb::union_tag_t>(tag_format);
+
+    ARROW_RETURN_NOT_OK(union_builder.Reserve(static_cast<int64_t>(count)));
+    std::vector<duckdb::idx_t> nullRows;
+    for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+        auto idx = format.sel->get_index(row_idx);
+        auto tag_idx = tag_format.sel->get_index(idx);
+        int8_t tag = 0;
+        if (format.validity.RowIsValid(idx) && tag_format.validity.RowIsValid(tag_idx)) {
+            tag = static_cast<int8_t>(tag_data[tag_idx]);
+        } else {
+            nullRows.push_back(row_idx);
+        }
+        ARROW_RETURN_NOT_OK(union_builder.Append(tag));
+    }
+
+    auto members = duckdb::UnionType::GetMemberCount(vector.GetType());
+    for (duckdb::idx_t i = 0; i < members; ++i) {
+        auto& member = duckdb::UnionVector::GetMember(vector, i);
+        if (i > 0 || nullRows.empty()) {
+            ARROW_RETURN_NOT_OK(AppendSelectedRows(*union_builder.child(static_cast<int>(i)), member, *format.sel,
+                                                   count));
+            continue;
+        }
+        // A sparse union has no validity bitmap of its own: a null row is
+        // read as its member 0 slot, so that slot has to be null as well
+        duckdb::Vector selected(member, *format.sel, count);
+        selected.Flatten(count);
+        for (auto row_idx : nullRows) {
+            duckdb::FlatVector::SetNull(selected, row_idx, true);
+        }
+        ARROW_RETURN_NOT_OK(AppendColumn(*union_builder.child(0), selected, count));
+    }
+    return arrow::Status::OK();
+}
+
+std::shared_ptr<arrow::DataType> ToArrowListType(const duckdb::LogicalType& type) {
+    auto child = ToArrowType(duckdb::ListType::GetChildType(type));
+    return child ? arrow::list(child) : nullptr;
+}
+
+std::shared_ptr<arrow::DataType> ToArrowFixedSizeListType(const duckdb::LogicalType& type) {
+    auto child = ToArrowType(duckdb::ArrayType::GetChildType(type));
+    auto size = static_cast<int32_t>(duckdb::ArrayType::GetSize(type));
+    return child ? arrow::fixed_size_list(child, size) : nullptr;
+}
+
+std::shared_ptr<arrow::DataType> ToArrowStructType(const duckdb::LogicalType& type) {
+    arrow::FieldVector fields;
+    for (auto& child : duckdb::StructType::GetChildTypes(type)) {
+        auto child_type = ToArrowType(child.second);
+        if (!child_type) {
+            return nullptr;
+        }
+        fields.push_back(arrow::field(child.first, child_type));
+    }
+    return arrow::struct_(fields);
+}
+
+std::shared_ptr<arrow::DataType> ToArrowMapType(const duckdb::LogicalType& type) {
+    auto key = ToArrowType(duckdb::MapType::KeyType(type));
+    auto value = ToArrowType(duckdb::MapType::ValueType(type));
+    return key && value ? arrow::map(key, value) : nullptr;
+}
+
+std::shared_ptr<arrow::DataType> ToArrowUnionType(const duckdb::LogicalType& type) {
+    auto members = duckdb::UnionType::GetMemberCount(type);
+    if (members > static_cast<duckdb::idx_t>(std::numeric_limits<int8_t>::max())) {
+        return nullptr;
+    }
+
+    arrow::FieldVector fields;
+    std::vector<int8_t> type_codes;
+    for (duckdb::idx_t i = 0; i < members; ++i) {
+        auto member_type = ToArrowType(duckdb::UnionType::GetMemberType(type, i));
+        if (!member_type) {
+            return nullptr;
+        }
+        fields.push_back(arrow::field(duckdb::UnionType::GetMemberName(type, i), member_type));
+        type_codes.push_back(static_cast<int8_t>(i));
+    }
+    return arrow::sparse_union(fields, type_codes);
+}
+
+using ArrowTypeFunction = std::shared_ptr<arrow::DataType> (*)(const duckdb::LogicalType&);
+using AppendFunction = arrow::Status (*)(arrow::ArrayBuilder&, duckdb::Vector&, duckdb::idx_t);
+
+// One entry per supported DuckDB type: the Arrow type it maps to and the
+// kernel that appends a vector of it to a builder created for that type
+struct ColumnKernel {
+    ArrowTypeFunction arrowType;
+    AppendFunction append;
+};
+
+template <typename BuilderType, typename T>
+arrow::Status AppendFixedWidth(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    return AppendVector<BuilderType, T>(static_cast<BuilderType&>(builder), vector, count);
+}
+
+template <typename BuilderType>
+arrow::Status AppendBinary(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    return AppendStringTVector(static_cast<BuilderType&>(builder), vector, count);
+}
+
+arrow::Status AppendDecimal(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    auto& decimal_builder = static_cast<arrow::Decimal128Builder&>(builder);
+    switch (vector.GetType().InternalType()) {
+        case duckdb::PhysicalType::INT16:
+            return AppendTransformedVector<arrow::Decimal128Builder, int16_t, duckdb::hugeint_t>(
+                decimal_builder, vector, count, WidenToHugeint<int16_t>);
+        case duckdb::PhysicalType::INT32:
+            return AppendTransformedVector<arrow::Decimal128Builder, int32_t, duckdb::hugeint_t>(
+                decimal_builder, vector, count, WidenToHugeint<int32_t>);
+        case duckdb::PhysicalType::INT64:
+            return AppendTransformedVector<arrow::Decimal128Builder, int64_t, duckdb::hugeint_t>(
+                decimal_builder, vector, count, WidenToHugeint<int64_t>);
+        case duckdb::PhysicalType::INT128:
+            return AppendTransformedVector<arrow::Decimal128Builder, duckdb::hugeint_t, duckdb::hugeint_t>(
+                decimal_builder, vector, count, IdentityHugeint);
+        default:
+            return arrow::Status::NotImplemented("Unsupported decimal storage: ", vector.GetType().ToString());
+    }
+}
+
+arrow::Status AppendHugeint(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    return AppendTransformedVector<arrow::Decimal128Builder, duckdb::hugeint_t, duckdb::hugeint_t>(
+        static_cast<arrow::Decimal128Builder&>(builder), vector, count, IdentityHugeint);
+}
+
+duckdb::hugeint_t UhugeintToHugeint(duckdb::uhugeint_t value) {
+    return duckdb::hugeint_t(static_cast<int64_t>(value.upper), value.lower);
+}
+
+// Values up to 2^127 - 1 keep their bits as a signed decimal128; anything
+// above has no Arrow representation and fails the column
+arrow::Status AppendUhugeint(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    duckdb::UnifiedVectorFormat format;
+    vector.ToUnifiedFormat(count, format);
+    auto data = duckdb::UnifiedVectorFormat::GetData<duckdb::uhugeint_t>(format);
+    for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+        auto idx = format.sel->get_index(row_idx);
+        auto upper = data[idx].upper;
+        if (format.validity.RowIsValid(idx) && upper > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+            return arrow::Status::Invalid("UHUGEINT value ", data[idx].ToString(), " does not fit in decimal128(38, 0)");
+        }
+    }
+    return AppendTransformedVector<arrow::Decimal128Builder, duckdb::uhugeint_t, duckdb::hugeint_t>(
+        static_cast<arrow::Decimal128Builder&>(builder), vector, count, UhugeintToHugeint);
+}
+
+arrow::Status AppendUuid(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    return AppendTransformedVector<arrow::FixedSizeBinaryBuilder, duckdb::hugeint_t, std::array<uint8_t, 16>>(
+        static_cast<arrow::FixedSizeBinaryBuilder&>(builder), vector, count, UuidToBytes);
+}
+
+arrow::Status AppendInterval(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    return AppendTransformedVector<arrow::MonthDayNanoIntervalBuilder, duckdb::interval_t,
+                                   arrow::MonthDayNanoIntervalType::MonthDayNanos>(
+        static_cast<arrow::MonthDayNanoIntervalBuilder&>(builder), vector, count, IntervalToMonthDayNanos);
+}
+
+// ENUM codes index the type's values in insertion order. A column nested in
+// another type is decoded to plain utf8 through the same two-pass copy as
+// VARCHAR; top-level columns become dictionary arrays instead
+template <typename T>
+arrow::Status AppendEnumStrings(arrow::StringBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    auto values = duckdb::FlatVector::GetData<duckdb::string_t>(
+        duckdb::EnumType::GetValuesInsertOrder(vector.GetType()));
+    duckdb::UnifiedVectorFormat format;
+    vector.ToUnifiedFormat(count, format);
+    auto codes = duckdb::UnifiedVectorFormat::GetData<T>(format);
+    auto all_valid = AllRowsValid(format, count);
+
+    int64_t total_length = 0;
+    for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+        auto idx = format.sel->get_index(row_idx);
+        if (all_valid || format.validity.RowIsValid(idx)) {
+            total_length += static_cast<int64_t>(values[codes[idx]].GetSize());
+        }
+    }
+
+    ARROW_RETURN_NOT_OK(builder.Reserve(static_cast<int64_t>(count)));
+    ARROW_RETURN_NOT_OK(builder.ReserveData(total_length));
+    for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+        auto idx = format.sel->get_index(row_idx);
+        if (all_valid || format.validity.RowIsValid(idx)) {
+            auto& value = values[codes[idx]];
+            builder.UnsafeAppend(value.GetData(), static_cast<int32_t>(value.GetSize()));
+        } else {
+            builder.UnsafeAppendNull();
+        }
+    }
+    return arrow::Status::OK();
+}
+
+// The dictionary builder of an ENUM column is seeded with the enum values,
+// so the codes are already its indices and nothing is hashed
+template <typename T>
+arrow::Status AppendEnumIndices(arrow::StringDictionary32Builder& builder, duckdb::Vector& vector,
+                                duckdb::idx_t count) {
+    duckdb::UnifiedVectorFormat format;
+    vector.ToUnifiedFormat(count, format);
+    auto codes = duckdb::UnifiedVectorFormat::GetData<T>(format);
+
+    std::vector<int32_t> indices(count);
+    for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+        indices[row_idx] = static_cast<int32_t>(codes[format.sel->get_index(row_idx)]);
+    }
+    auto validBytes = CollectValidBytes(format, count);
+    return builder.AppendIndices(indices.data(), static_cast<int64_t>(count), ValidBytesOrNull(validBytes));
+}
+
+arrow::Status AppendEnum(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    auto& string_builder = static_cast<arrow::StringBuilder&>(builder);
+    switch (vector.GetType().InternalType()) {
+        case duckdb::PhysicalType::UINT8:
+            return AppendEnumStrings<uint8_t>(string_builder, vector, count);
+        case duckdb::PhysicalType::UINT16:
+            return AppendEnumStrings<uint16_t>(string_builder, vector, count);
+        case duckdb::PhysicalType::UINT32:
+            return AppendEnumStrings<uint32_t>(string_builder, vector, count);
+        default:
+            return arrow::Status::NotImplemented("Unsupported enum storage: ", vector.GetType().ToString());
+    }
+}
+
+// Appends a top-level ENUM or dictionary-encoded VARCHAR column
+arrow::Status AppendDictionaryColumn(arrow::StringDictionary32Builder& builder, duckdb::Vector& vector,
+                                     duckdb::idx_t count) {
+    if (vector.GetType().id() == duckdb::LogicalTypeId::ENUM) {
+        switch (vector.GetType().InternalType()) {
+            case duckdb::PhysicalType::UINT8:
+                return AppendEnumIndices<uint8_t>(builder, vector, count);
+            case duckdb::PhysicalType::UINT16:
+                return AppendEnumIndices<uint16_t>(builder, vector, count);
+            case duckdb::PhysicalType::UINT32:
+                return AppendEnumIndices<uint32_t>(builder, vector, count);
+            default:
+                return arrow::Status::NotImplemented("Unsupported enum storage: ", vector.GetType().ToString());
+        }
+    }
+
+    // VARCHAR values go through the builder's memo table, which keeps its
+    // indices stable across batches
+    duckdb::UnifiedVectorFormat format;
+    vector.ToUnifiedFormat(count, format);
+    auto data = duckdb::UnifiedVectorFormat::GetData<duckdb::string_t>(format);
+    ARROW_RETURN_NOT_OK(builder.Reserve(static_cast<int64_t>(count)));
+    for (duckdb::idx_t row_idx = 0; row_idx < count; ++row_idx) {
+        auto idx = format.sel->get_index(row_idx);
+        if (format.validity.RowIsValid(idx)) {
+            ARROW_RETURN_NOT_OK(builder.Append(std::string_view(data[idx].GetData(), data[idx].GetSize())));
+        } else {
+            ARROW_RETURN_NOT_OK(builder.AppendNull());
+        }
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Result<std::shared_ptr<arrow::Array>> EnumDictionary(const duckdb::LogicalType& type, arrow::MemoryPool* pool) {
+    auto size = duckdb::EnumType::GetSize(type);
+    auto values = duckdb::FlatVector::GetData<duckdb::string_t>(duckdb::EnumType::GetValuesInsertOrder(type));
+    arrow::StringBuilder builder(pool);
+    for (duckdb::idx_t i = 0; i < size; ++i) {
+        ARROW_RETURN_NOT_OK(builder.Append(values[i].GetData(), static_cast<int32_t>(values[i].GetSize())));
+    }
+    return builder.Finish();
+}
+
+// Turns the indices FinishDelta() hands out into a dictionary array. The
+// memo table only ever grows, so a later dictionary is valid for earlier
+// indices as well
+std::shared_ptr<arrow::Array> WithDictionary(const std::shared_ptr<arrow::Array>& indices,
+                                             const std::shared_ptr<arrow::DataType>& type,
+                                             const std::shared_ptr<arrow::Array>& dictionary) {
+    auto data = indices->data()->Copy();
+    data->type = type;
+    data->dictionary = dictionary->data();
+    return arrow::MakeArray(data);
+}
+
+bool IsDictionaryColumn(const duckdb::LogicalType& type, const std::string& name,
+                        const std::unordered_set<std::string>& dictionaryColumns) {
+    return type.id() == duckdb::LogicalTypeId::ENUM ||
+           (type.id() == duckdb::LogicalTypeId::VARCHAR && dictionaryColumns.count(name) > 0);
+}
+
+const std::unordered_map<duckdb::LogicalTypeId, ColumnKernel>& KernelTable() {
+    using duckdb::LogicalType;
+    using duckdb::LogicalTypeId;
+    static const std::unordered_map<LogicalTypeId, ColumnKernel> kernels = {
+        {LogicalTypeId::BOOLEAN, {[](const LogicalType&) { return arrow::boolean(); },
+                                  AppendFixedWidth<arrow::BooleanBuilder, uint8_t>}},
+        {LogicalTypeId::TINYINT, {[](const LogicalType&) { return arrow::int8(); },
+                                  AppendFixedWidth<arrow::Int8Builder, int8_t>}},
+        {LogicalTypeId::SMALLINT, {[](const LogicalType&) { return arrow::int16(); },
+                                   AppendFixedWidth<arrow::Int16Builder, int16_t>}},
+        {LogicalTypeId::INTEGER, {[](const LogicalType&) { return arrow::int32(); },
+                                  AppendFixedWidth<arrow::Int32Builder, int32_t>}},
+        {LogicalTypeId::BIGINT, {[](const LogicalType&) { return arrow::int64(); },
+                                 AppendFixedWidth<arrow::Int64Builder, int64_t>}},
+        {LogicalTypeId::UTINYINT, {[](const LogicalType&) { return arrow::uint8(); },
+                                   AppendFixedWidth<arrow::UInt8Builder, uint8_t>}},
+        {LogicalTypeId::USMALLINT, {[](const LogicalType&) { return arrow::uint16(); },
+                                    AppendFixedWidth<arrow::UInt16Builder, uint16_t>}},
+        {LogicalTypeId::UINTEGER, {[](const LogicalType&) { return arrow::uint32(); },
+                                   AppendFixedWidth<arrow::UInt32Builder, uint32_t>}},
+        {LogicalTypeId::UBIGINT, {[](const LogicalType&) { return arrow::uint64(); },
+                                  AppendFixedWidth<arrow::UInt64Builder, uint64_t>}},
+        {LogicalTypeId::FLOAT, {[](const LogicalType&) { return arrow::float32(); },
+                                AppendFixedWidth<arrow::FloatBuilder, float>}},
+        {LogicalTypeId::DOUBLE, {[](const LogicalType&) { return arrow::float64(); },
+                                 AppendFixedWidth<arrow::DoubleBuilder, double>}},
+        // date_t, dtime_t and timestamp_t are plain day/microsecond counts
+        {LogicalTypeId::DATE, {[](const LogicalType&) { return arrow::date32(); },
+                               AppendFixedWidth<arrow::Date32Builder, int32_t>}},
+        {LogicalTypeId::TIME, {[](const LogicalType&) { return arrow::time64(arrow::TimeUnit::MICRO); },
+                               AppendFixedWidth<arrow::Time64Builder, int64_t>}},
+        {LogicalTypeId::TIMESTAMP_SEC, {[](const LogicalType&) { return arrow::timestamp(arrow::TimeUnit::SECOND); },
+                                        AppendFixedWidth<arrow::TimestampBuilder, int64_t>}},
+        {LogicalTypeId::TIMESTAMP_MS, {[](const LogicalType&) { return arrow::timestamp(arrow::TimeUnit::MILLI); },
+                                       AppendFixedWidth<arrow::TimestampBuilder, int64_t>}},
+        {LogicalTypeId::TIMESTAMP, {[](const LogicalType&) { return arrow::timestamp(arrow::TimeUnit::MICRO); },
+                                    AppendFixedWidth<arrow::TimestampBuilder, int64_t>}},
+        {LogicalTypeId::TIMESTAMP_NS, {[](const LogicalType&) { return arrow::timestamp(arrow::TimeUnit::NANO); },
+                                       AppendFixedWidth<arrow::TimestampBuilder, int64_t>}},
+        {LogicalTypeId::TIMESTAMP_TZ, {[](const LogicalType&) { return arrow::timestamp(arrow::TimeUnit::MICRO, "UTC"); },
+                                       AppendFixedWidth<arrow::TimestampBuilder, int64_t>}},
+        {LogicalTypeId::DECIMAL, {[](const LogicalType& type) {
+                                      return arrow::decimal128(duckdb::DecimalType::GetWidth(type),
+                                                               duckdb::DecimalType::GetScale(type));
+                                  },
+                                  AppendDecimal}},
+        // Arrow has no 128-bit integer; DuckDB's own Arrow export uses decimal(38, 0) too
+        {LogicalTypeId::HUGEINT, {[](const LogicalType&) { return arrow::decimal128(38, 0); }, AppendHugeint}},
+        {LogicalTypeId::UHUGEINT, {[](const LogicalType&) { return arrow::decimal128(38, 0); }, AppendUhugeint}},
+        {LogicalTypeId::UUID, {[](const LogicalType&) { return arrow::fixed_size_binary(16); }, AppendUuid}},
+        {LogicalTypeId::INTERVAL, {[](const LogicalType&) { return arrow::month_day_nano_interval(); },
+                                   AppendInterval}},
+        {LogicalTypeId::VARCHAR, {[](const LogicalType&) { return arrow::utf8(); },
+                                  AppendBinary<arrow::StringBuilder>}},
+        {LogicalTypeId::BLOB, {[](const LogicalType&) { return arrow::binary(); },
+                               AppendBinary<arrow::BinaryBuilder>}},
+        {LogicalTypeId::ENUM, {[](const LogicalType&) { return arrow::utf8(); }, AppendEnum}},
+        // Nested types recurse into AppendColumn once per child, not per row
+        {LogicalTypeId::LIST, {ToArrowListType, AppendList}},
+        {LogicalTypeId::ARRAY, {ToArrowFixedSizeListType, AppendArray}},
+        {LogicalTypeId::STRUCT, {ToArrowStructType, AppendStruct}},
+        {LogicalTypeId::MAP, {ToArrowMapType, AppendMap}},
+        {LogicalTypeId::UNION, {ToArrowUnionType, AppendUnion}},
+    };
+    return kernels;
+}
+
+// utf8 and binary columns share BinaryBuilder's offsets + data layout
+bool IsBinaryColumn(const arrow::ArrayBuilder& builder) {
+    auto id = builder.type()->id();
+    return id == arrow::Type::STRING || id == arrow::Type::BINARY;
+}
+
+// Bytes a builder holds so far: its validity bitmap, offsets or type codes,
+// values or string payload, and those of its children
+int64_t BuilderBytes(const arrow::ArrayBuilder& builder) {
+    auto length = builder.length();
+    int64_t bytes = (length + 7) / 8;
+    switch (builder.type()->id()) {
+        case arrow::Type::STRING:
+        case arrow::Type::BINARY:
+            return bytes + static_cast<const arrow::BinaryBuilder&>(builder).value_data_length() +
+                   length * static_cast<int64_t>(sizeof(int32_t));
+        case arrow::Type::LIST:
+            return bytes + length * static_cast<int64_t>(sizeof(int32_t)) +
+                   BuilderBytes(*static_cast<const arrow::ListBuilder&>(builder).value_builder());
+        case arrow::Type::MAP: {
+            auto& map_builder = static_cast<const arrow::MapBuilder&>(builder);
+            return bytes + length * static_cast<int64_t>(sizeof(int32_t)) + BuilderBytes(*map_builder.key_builder()) +
+                   BuilderBytes(*map_builder.item_builder());
+        }
+        case arrow::Type::FIXED_SIZE_LIST:
+            return bytes + BuilderBytes(*static_cast<const arrow::FixedSizeListBuilder&>(builder).value_builder());
+        case arrow::Type::STRUCT:
+        case arrow::Type::SPARSE_UNION:
+            if (builder.type()->id() == arrow::Type::SPARSE_UNION) {
+                // One type code per row instead of a bitmap
+                bytes = length;
+            }
+            for (int i = 0; i < builder.num_children(); ++i) {
+                bytes += BuilderBytes(*builder.child_builder(i));
+            }
+            return bytes;
+        default: {
+            auto fixedWidth = dynamic_cast<const arrow::FixedWidthType*>(builder.type().get());
+            return fixedWidth ? bytes + (length * fixedWidth->bit_width() + 7) / 8 : bytes;
+        }
+    }
+}
+
+// Bytes per row of the same buffers, leaving out string payload and assuming
+// one child element per list, map or union member. A rough lower bound that
+// sizes the first byte-bounded batch
+int64_t FixedRowBytes(const arrow::DataType& type) {
+    switch (type.id()) {
+        case arrow::Type::STRING:
+        case arrow::Type::BINARY:
+            return static_cast<int64_t>(sizeof(int32_t));
+        case arrow::Type::LIST:
+        case arrow::Type::MAP: {
+            int64_t bytes = static_cast<int64_t>(sizeof(int32_t));
+            for (const auto& field : type.fields()) {
+                bytes += FixedRowBytes(*field->type());
+            }
+            return bytes;
+        }
+        case arrow::Type::FIXED_SIZE_LIST:
+            return static_cast<const arrow::FixedSizeListType&>(type).list_size() * FixedRowBytes(*type.field(0)->type());
+        case arrow::Type::STRUCT:
+        case arrow::Type::SPARSE_UNION: {
+            int64_t bytes = type.id() == arrow::Type::SPARSE_UNION ? 1 : 0;
+            for (const auto& field : type.fields()) {
+                bytes += FixedRowBytes(*field->type());
+            }
+            return bytes;
+        }
+        default: {
+            auto fixedWidth = dynamic_cast<const arrow::FixedWidthType*>(&type);
+            return fixedWidth ? std::max(fixedWidth->bit_width() / 8, 1) : 1;
+        }
+    }
+}
+
+const ColumnKernel* FindKernel(const duckdb::LogicalType& type) {
+    auto& kernels = KernelTable();
+    auto kernel = kernels.find(type.id());
+    return kernel == kernels.end() ? nullptr : &kernel->second;
+}
+
+} // namespace
+
+std::shared_ptr<arrow::DataType> ToArrowType(const duckdb::LogicalType& type) {
+    auto kernel = FindKernel(type);
+    return kernel ? kernel->arrowType(type) : nullptr;
+}
+
+arrow::Result<std::shared_ptr<arrow::Schema>> ToArrowSchema(
+    const duckdb::vector<duckdb::LogicalType>& types, const duckdb::vector<std::string>& names,
+    const std::unordered_set<std::string>& dictionaryColumns) {
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    fields.reserve(types.size());
+    for (duckdb::idx_t col_idx = 0; col_idx < types.size(); ++col_idx) {
+        auto type = IsDictionaryColumn(types[col_idx], names[col_idx], dictionaryColumns)
+                        ? arrow::dictionary(arrow::int32(), arrow::utf8())
+                        : ToArrowType(types[col_idx]);
+        if (!type) {
+            return arrow::Status::NotImplemented("Unsupported data type in column: ", names[col_idx],
+                                                 " (", types[col_idx].ToString(), ")");
+        }
+        fields.push_back(arrow::field(names[col_idx], type));
+    }
+    return arrow::schema(fields);
+}
+
+arrow::Status AppendColumn(arrow::ArrayBuilder& builder, duckdb::Vector& vector, duckdb::idx_t count) {
+    auto kernel = FindKernel(vector.GetType());
+    if (!kernel) {
+        return arrow::Status::NotImplemented("Unsupported data type: ", vector.GetType().ToString());
+    }
+    return kernel->append(builder, vector, count);
+}
+
+arrow::Result<std::unique_ptr<ChunkAccumulator>> ChunkAccumulator::Make(
+    const duckdb::vector<duckdb::LogicalType>& types, const duckdb::vector<std::string>& names, BatchSize batchSize,
+    const std::unordered_set<std::string>& dictionaryColumns, arrow::MemoryPool* pool) {
+    if (batchSize.rows < 0 || batchSize.bytes < 0) {
+        return arrow::Status::Invalid("Batch size must not be negative");
+    }
+
+    ARROW_ASSIGN_OR_RAISE(auto schema, ToArrowSchema(types, names, dictionaryColumns));
+    std::unique_ptr<ChunkAccumulator> accumulator(new ChunkAccumulator(std::move(schema), batchSize, pool));
+    for (duckdb::idx_t col_idx = 0; col_idx < types.size(); ++col_idx) {
+        std::unique_ptr<arrow::ArrayBuilder> builder;
+        if (types[col_idx].id() == duckdb::LogicalTypeId::ENUM) {
+            // Seeded with the enum values, which then come out as the first
+            // delta, so the codes are the dictionary indices
+            ARROW_ASSIGN_OR_RAISE(auto values, EnumDictionary(types[col_idx], pool));
+            builder = std::make_unique<arrow::StringDictionary32Builder>(values, pool);
+        } else if (IsDictionaryColumn(types[col_idx], names[col_idx], dictionaryColumns)) {
+            builder = std::make_unique<arrow::StringDictionary32Builder>(pool);
+        } else {
+            ARROW_ASSIGN_OR_RAISE(builder, arrow::MakeBuilder(accumulator->outputSchema->field(col_idx)->type(), pool));
+        }
+        accumulator->builders.push_back(std::move(builder));
+        auto perfKey = duckdb::LogicalTypeIdToString(types[col_idx].id());
+        if (types[col_idx].id() == duckdb::LogicalTypeId::VARCHAR &&
+            IsDictionaryColumn(types[col_idx], names[col_idx], dictionaryColumns)) {
+            perfKey += " (dictionary)";
+        }
+        accumulator->perfKeys.push_back(std::move(perfKey));
+    }
+    return accumulator;
+}
+
+ChunkAccumulator::ChunkAccumulator(std::shared_ptr<arrow::Schema> schema, BatchSize batchSize,
+                                   arrow::MemoryPool* pool)
+    : outputSchema(std::move(schema)), batchSize(batchSize), pool(pool), bytesPerRow(outputSchema->num_fields(), 0.0),
+      dictionaries(outputSchema->num_fields()), dictionaryDeltas(outputSchema->num_fields()),
+      chunks(outputSchema->num_fields()) {
+}
+
+arrow::Status ChunkAccumulator::append(duckdb::DataChunk& chunk) {
+    if (chunk.ColumnCount() != builders.size()) {
+        return arrow::Status::Invalid("Chunk has ", chunk.ColumnCount(), " columns, schema has ", builders.size());
+    }
+    if (builders.empty()) {
+        return arrow::Status::OK();
+    }
+
+    auto rows = static_cast<int64_t>(chunk.size());
+    if (batchSize.rows == 0 || batchRows + rows <= batchSize.rows) {
+        return appendRows(chunk);
+    }
+    // Split the chunk at the row target. Flat vectors are sliced in place,
+    // so the parts still take the flat conversion paths
+    int64_t offset = 0;
+    while (offset < rows) {
+        // A full batch is closed as soon as it fills, so there is always room
+        auto count = std::min(rows - offset, batchSize.rows - batchRows);
+        duckdb::DataChunk part;
+        part.InitializeEmpty(chunk.GetTypes());
+        for (duckdb::idx_t col_idx = 0; col_idx < chunk.ColumnCount(); ++col_idx) {
+            part.data[col_idx].Slice(chunk.data[col_idx], static_cast<duckdb::idx_t>(offset),
+                                     static_cast<duckdb::idx_t>(offset + count));
+        }
+        part.SetCardinality(static_cast<duckdb::idx_t>(count));
+        ARROW_RETURN_NOT_OK(appendRows(part));
+        offset += count;
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Status ChunkAccumulator::appendRows(duckdb::DataChunk& chunk) {
+    auto rows = static_cast<int64_t>(chunk.size());
+    PendingChunk entry;
+    entry.reserveRows = batchRows == 0 ? batchReserveRows(rows) : 0;
+    appendedRows += rows;
+    batchRows += rows;
+    // Row targets (and no target at all, which makes every DataChunk a batch)
+    // are known to be reached before converting; a byte target only after
+    entry.endsBatch = (batchSize.rows == 0 && batchSize.bytes == 0) ||
+                      (batchSize.rows > 0 && batchRows >= batchSize.rows);
+    if (entry.endsBatch) {
+        lastBatchRows = batchRows;
+        batchRows = 0;
+    }
+
+    if (!parallel) {
+        entry.chunk = &chunk;
+        ARROW_RETURN_NOT_OK(convert(&entry, 1));
+        return closeByteBatch();
+    }
+
+    // The span outlives the caller's chunk, so it keeps a reference to its
+    // vectors rather than a copy
+    auto held = std::make_unique<duckdb::DataChunk>();
+    held->InitializeEmpty(chunk.GetTypes());
+    held->Reference(chunk);
+    entry.chunk = held.get();
+    pendingData.push_back(std::move(held));
+    pending.push_back(entry);
+    pendingRows += rows;
+
+    // Until a byte-bounded batch has been measured, every chunk is converted
+    // and checked on its own; after that, once the batch holds as many rows
+    // as the previous one did
+    bool ready = pendingRows >= kParallelSpanRows || (batchSize.rows > 0 && entry.endsBatch);
+    ready = ready || (batchSize.bytes > 0 && (lastBatchRows == 0 || batchRows >= lastBatchRows));
+    return ready ? convertPending() : arrow::Status::OK();
+}
+
+arrow::Status ChunkAccumulator::convert(const PendingChunk* span, size_t count) {
+    int64_t spanRows = 0;
+    for (size_t i = 0; i < count; ++i) {
+        spanRows += static_cast<int64_t>(span[i].chunk->size());
+    }
+
+    // Every column has its own builder, so each task takes one column through
+    // the whole span, closing the batches that end inside it
+    auto convertColumn = [&](int col_idx) -> arrow::Status {
+        PerfScope perfScope(perfProfile, perfKeys[col_idx], spanRows);
+        bool dictionary = outputSchema->field(col_idx)->type()->id() == arrow::Type::DICTIONARY;
+        for (size_t i = 0; i < count; ++i) {
+            if (span[i].reserveRows > 0) {
+                ARROW_RETURN_NOT_OK(reserveColumn(col_idx, span[i].reserveRows));
+            }
+            auto& builder = *builders[col_idx];
+            auto& vector = span[i].chunk->data[col_idx];
+            auto status = dictionary ? AppendDictionaryColumn(static_cast<arrow::StringDictionary32Builder&>(builder),
+                                                              vector, span[i].chunk->size())
+                                     : AppendColumn(builder, vector, span[i].chunk->size());
+            if (!status.ok()) {
+                return status.WithMessage("Failed to append column ", outputSchema->field(col_idx)->name(), ": ",
+                                          status.message());
+            }
+            if (span[i].endsBatch) {
+                ARROW_RETURN_NOT_OK(finishColumn(col_idx));
+            }
+        }
+        return arrow::Status::OK();
+    };
+    auto columnCount = static_cast<int>(builders.size());
+    return arrow::internal::OptionalParallelFor(parallel && columnCount > 1, columnCount, convertColumn);
+}
+
+arrow::Status ChunkAccumulator::convertPending() {
+    if (pending.empty()) {
+        return arrow::Status::OK();
+    }
+    auto status = convert(pending.data(), pending.size());
+    pending.clear();
+    pendingData.clear();
+    pendingRows = 0;
+    ARROW_RETURN_NOT_OK(status);
+    return closeByteBatch();
+}
+
+arrow::Status ChunkAccumulator::closeByteBatch() {
+    if (batchSize.bytes > 0 && batchRows > 0 && batchBytes() >= batchSize.bytes) {
+        return flush();
+    }
+    return arrow::Status::OK();
+}
+
+int64_t ChunkAccumulator::batchReserveRows(int64_t chunkRows) const {
+    // Without a row target the batch is a single DataChunk
+    int64_t rows = batchSize.rows > 0 ? batchSize.rows : chunkRows;
+    if (batchSize.rows == 0 && batchSize.bytes > 0 && lastBatchRows > 0) {
+        // The previous batch shows how many rows fit in the byte target
+        rows = std::max(rows, lastBatchRows);
+    } else if (batchSize.rows == 0 && batchSize.bytes > 0) {
+        // Guess the first one from the fixed-width part of a row. Strings
+        // and nested values make that an underestimate of the row size, so
+        // the guess is capped and the builders grow past it if need be
+        int64_t rowWidth = 0;
+        for (const auto& field : outputSchema->fields()) {
+            rowWidth += FixedRowBytes(*field->type());
+        }
+        auto guess = std::min(batchSize.bytes / std::max<int64_t>(rowWidth, 1), kMaxGuessedBatchRows);
+        rows = std::max(rows, guess);
+    }
+    if (expectedRows >= 0) {
+        // The last batch of a known-size result only needs what is left
+        rows = std::min(rows, std::max(expectedRows - appendedRows, chunkRows));
+    }
+    return rows;
+}
+
+arrow::Status ChunkAccumulator::reserveColumn(int col_idx, int64_t rows) {
+    ARROW_RETURN_NOT_OK(builders[col_idx]->Reserve(rows));
+    if (IsBinaryColumn(*builders[col_idx]) && bytesPerRow[col_idx] > 0) {
+        auto& builder = static_cast<arrow::BinaryBuilder&>(*builders[col_idx]);
+        ARROW_RETURN_NOT_OK(builder.ReserveData(static_cast<int64_t>(bytesPerRow[col_idx] * rows)));
+    }
+    return arrow::Status::OK();
+}
+
+int64_t ChunkAccumulator::batchBytes() const {
+    int64_t bytes = 0;
+    for (const auto& builder : builders) {
+        bytes += BuilderBytes(*builder);
+    }
+    return bytes;
+}
+
+arrow::Status ChunkAccumulator::finishColumn(int col_idx) {
+    if (IsBinaryColumn(*builders[col_idx])) {
+        auto& builder = static_cast<arrow::BinaryBuilder&>(*builders[col_idx]);
+        bytesPerRow[col_idx] = static_cast<double>(builder.value_data_length()) / builder.length();
+    }
+
+    std::shared_ptr<arrow::Array> array;
+    if (builders[col_idx]->type()->id() == arrow::Type::DICTIONARY) {
+        // Finish() would copy the whole memo table into a new dictionary for
+        // every batch; FinishDelta() only hands out the values added since
+        // the last one, and the chunk keeps plain indices until it is taken
+        std::shared_ptr<arrow::Array> delta;
+        auto& builder = static_cast<arrow::StringDictionary32Builder&>(*builders[col_idx]);
+        ARROW_RETURN_NOT_OK(builder.FinishDelta(&array, &delta));
+        if (delta->length() > 0) {
+            dictionaryDeltas[col_idx].push_back(std::move(delta));
+        }
+    } else {
+        ARROW_RETURN_NOT_OK(builders[col_idx]->Finish(&array));
+    }
+    chunks[col_idx].push_back(std::move(array));
+    return arrow::Status::OK();
+}
+
+arrow::Status ChunkAccumulator::mergeDictionary(int col_idx) {
+    auto& deltas = dictionaryDeltas[col_idx];
+    if (deltas.empty()) {
+        if (!dictionaries[col_idx]) {
+            // Nothing but nulls so far
+            ARROW_ASSIGN_OR_RAISE(dictionaries[col_idx], arrow::MakeEmptyArray(arrow::utf8(), pool));
+        }
+        return arrow::Status::OK();
+    }
+    if (dictionaries[col_idx]) {
+        deltas.insert(deltas.begin(), dictionaries[col_idx]);
+    }
+    if (deltas.size() == 1) {
+        dictionaries[col_idx] = deltas[0];
+    } else {
+        ARROW_ASSIGN_OR_RAISE(dictionaries[col_idx], arrow::Concatenate(deltas, pool));
+    }
+    deltas.clear();
+    return arrow::Status::OK();
+}
+
+arrow::Result<std::shared_ptr<arrow::Array>> ChunkAccumulator::takeChunk(int col_idx,
+                                                                         std::shared_ptr<arrow::Array> array) {
+    auto& type = outputSchema->field(col_idx)->type();
+    if (type->id() != arrow::Type::DICTIONARY) {
+        return array;
+    }
+    ARROW_RETURN_NOT_OK(mergeDictionary(col_idx));
+    return WithDictionary(array, type, dictionaries[col_idx]);
+}
+
+arrow::Status ChunkAccumulator::flush() {
+    ARROW_RETURN_NOT_OK(convertPending());
+    if (builders.empty() || builders[0]->length() == 0) {
+        return arrow::Status::OK();
+    }
+
+    lastBatchRows = builders[0]->length();
+    batchRows = 0;
+    for (size_t col_idx = 0; col_idx < builders.size(); ++col_idx) {
+        ARROW_RETURN_NOT_OK(finishColumn(static_cast<int>(col_idx)));
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> ChunkAccumulator::takeBatch() {
+    if (chunks.empty() || chunks[0].empty()) {
+        return nullptr;
+    }
+
+    arrow::ArrayVector columns;
+    columns.reserve(chunks.size());
+    for (size_t col_idx = 0; col_idx < chunks.size(); ++col_idx) {
+        auto& column = chunks[col_idx];
+        ARROW_ASSIGN_OR_RAISE(auto array, takeChunk(static_cast<int>(col_idx), std::move(column.front())));
+        columns.push_back(std::move(array));
+        column.erase(column.begin());
+    }
+    auto rows = columns[0]->length();
+    return arrow::RecordBatch::Make(outputSchema, rows, std::move(columns));
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> ChunkAccumulator::finish() {
+    ARROW_RETURN_NOT_OK(flush());
+
+    std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+    columns.reserve(chunks.size());
+    for (size_t col_idx = 0; col_idx < chunks.size(); ++col_idx) {
+        // The deltas of a dictionary column are merged once, and every chunk
+        // shares the result
+        auto& column = chunks[col_idx];
+        for (auto& array : column) {
+            ARROW_ASSIGN_OR_RAISE(array, takeChunk(static_cast<int>(col_idx), std::move(array)));
+        }
+        columns.push_back(std::make_shared<arrow::ChunkedArray>(std::move(column),
+                                                                outputSchema->field(static_cast<int>(col_idx))->type()));
+    }
+    chunks.assign(columns.size(), arrow::ArrayVector());
+    return arrow::Table::Make(outputSchema, columns);
+}
@@ -1,4 +1,6 @@
 #include "data_processor.hpp"
+#include "column_converter.hpp"
+#include "spsc_queue.hpp"
 #include <duckdb.hpp>
 //#include <duckdb/common/arrow/arrow.hpp>
 //#include <duckdb/common/arrow/arrow_converter.hpp>
@@ -7,22 +9,303 @@
 #include <arrow/io/api.h>
 #include <arrow/ipc/api.h>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <unistd.h>
+#endif
 #include <arrow/c/bridge.h>
+#include <arrow/util/byte_size.h>
+#include <algorithm>
+#include <filesystem>
+#include <functional>
 
 
+namespace {
+
+// Chunks the fetch thread may run ahead of conversion in pipelined mode
+constexpr size_t kPipelineDepth = 8;
+
+std::string QuoteIdentifier(const std::string& name) {
+    std::string quoted = "\"";
+    for (char c : name) {
+        quoted += c;
+        if (c == '"') {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+const char* CompareOpToSQL(CompareOp op) {
+    switch (op) {
+        case CompareOp::Equal:
+            return " = ";
+        case CompareOp::Less:
+            return " < ";
+        case CompareOp::LessEqual:
+            return " <= ";
+        case CompareOp::Greater:
+            return " > ";
+        case CompareOp::GreaterEqual:
+            return " >= ";
+    }
+    return " = ";
+}
+
+arrow::Result<std::shared_ptr<arrow::Schema>> ImportResultSchema(duckdb::QueryResult& result) {
+    ArrowSchema arrow_schema;
+    duckdb::ArrowConverter::ToArrowSchema(&arrow_schema, result.types, result.names, result.client_properties);
+    return arrow::ImportSchema(&arrow_schema);
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> ImportChunk(duckdb::DataChunk& chunk,
+                                                               const std::shared_ptr<arrow::Schema>& schema,
+                                                               const duckdb::ClientProperties& options) {
+    ArrowArray arrow_array;
+    duckdb::ArrowConverter::ToArrowArray(chunk, &arrow_array, options);
+    return arrow::ImportRecordBatch(&arrow_array, schema);
+}
+
+// Fetches the next chunk of `result`, timing it as the fetch stage
+duckdb::unique_ptr<duckdb::DataChunk> FetchChunk(duckdb::QueryResult& result, StageStats& fetchStats) {
+    StageTimer timer(fetchStats);
+    auto chunk = result.FetchRaw();
+    if (chunk) {
+        fetchStats.rows += static_cast<int64_t>(chunk->size());
+    }
+    return chunk;
+}
+
+// Runs `consume` on a chunk, turning what DuckDB's converters (ToArrowArray,
+// ToUnifiedFormat, Flatten) or an allocation may throw into a Status
+template <typename Consumer>
+arrow::Status ConsumeChunk(Consumer& consume, duckdb::DataChunk& chunk) {
+    try {
+        return consume(chunk);
+    } catch (const std::bad_alloc&) {
+        return arrow::Status::OutOfMemory("Out of memory converting a DuckDB chunk");
+    } catch (const std::exception& e) {
+        return arrow::Status::ExecutionError(e.what());
+    }
+}
+
+// Feeds every chunk of `result` to `consume`. When pipelined, a producer
+// thread keeps fetching from DuckDB into a bounded queue while the calling
+// thread converts, so fetch latency and conversion overlap.
+// FetchRaw keeps DuckDB's CONSTANT/DICTIONARY encodings instead of flattening them
+template <typename Consumer>
+arrow::Status ForEachChunk(duckdb::QueryResult& result, bool pipelined, StageStats& fetchStats, Consumer&& consume) {
+    if (!pipelined) {
+        while (true) {
+            auto chunk = FetchChunk(result, fetchStats);
+            if (!chunk || chunk->size() == 0) {
+                break;
+            }
+            ARROW_RETURN_NOT_OK(ConsumeChunk(consume, *chunk));
+        }
+        // A streamed result reports execution errors by ending early
+        if (result.HasError()) {
+            return arrow::Status::ExecutionError(result.GetError());
+        }
+        return arrow::Status::OK();
+    }
+
+    // A null chunk tells the consumer that fetching stopped, at the end of
+    // the result or on an error; which one is checked after the join
+    SpscQueue<std::unique_ptr<duckdb::DataChunk>> queue(kPipelineDepth);
+    std::atomic<bool> stop{false};
+    std::string fetchError;
+    std::thread producer([&]() {
+        try {
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto chunk = FetchChunk(result, fetchStats);
+                if (!chunk || chunk->size() == 0) {
+                    break;
+                }
+                queue.push(std::move(chunk));
+            }
+        } catch (const std::exception& e) {
+            fetchError = e.what();
+        }
+        queue.push(nullptr);
+    });
+
+    // Nothing in this loop may throw: leaving it with the producer still
+    // running would destroy a joinable std::thread
+    auto status = arrow::Status::OK();
+    while (auto chunk = queue.pop()) {
+        if (status.ok()) {
+            status = ConsumeChunk(consume, *chunk);
+            if (!status.ok()) {
+                // Keep draining so the producer is never left blocked on a full queue
+                stop.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+    producer.join();
+
+    if (status.ok() && !fetchError.empty()) {
+        return arrow::Status::ExecutionError(fetchError);
+    }
+    if (status.ok() && result.HasError()) {
+        return arrow::Status::ExecutionError(result.GetError());
+    }
+    return status;
+}
+
+// Pulls chunks from a streaming DuckDB result only when the consumer asks for
+// the next batch, so at most one batch is held in memory at a time. Without an
+// accumulator the chunks go through the C Data Interface instead of builders.
+// An accumulator allocating from a recycling arena comes with that arena.
+class QueryResultBatchReader : public arrow::RecordBatchReader {
+public:
+    QueryResultBatchReader(std::unique_ptr<duckdb::QueryResult> result, std::shared_ptr<arrow::Schema> schema,
+                           std::shared_ptr<RecyclingMemoryPool> arena, std::unique_ptr<ChunkAccumulator> accumulator,
+                           ProcessStats& stats, std::function<void()> onFinish)
+        : result(std::move(result)), outputSchema(std::move(schema)), arena(std::move(arena)),
+          accumulator(std::move(accumulator)), stats(stats), onFinish(std::move(onFinish)) {
+    }
+
+    std::shared_ptr<arrow::Schema> schema() const override {
+        return outputSchema;
+    }
+
+    arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) override {
+        while (true) {
+            if (accumulator) {
+                ARROW_ASSIGN_OR_RAISE(*batch, accumulator->takeBatch());
+                if (*batch) {
+                    if (arena) {
+                        *batch = RetainArena(*batch, arena);
+                    }
+                    stats.convert.bytes += arrow::util::TotalBufferSize(**batch);
+                    return arrow::Status::OK();
+                }
+            }
+            if (finished) {
+                *batch = nullptr;
+                return arrow::Status::OK();
+            }
+
+            std::unique_ptr<duckdb::DataChunk> chunk;
+            try {
+                chunk = FetchChunk(*result, stats.fetch);
+            } catch (const std::exception& e) {
+                return arrow::Status::ExecutionError(e.what());
+            }
+            if (result->HasError()) {
+                return arrow::Status::ExecutionError(result->GetError());
+            }
+
+            StageTimer timer(stats.convert);
+            if (!chunk || chunk->size() == 0) {
+                finished = true;
+                onFinish();
+                if (accumulator) {
+                    ARROW_RETURN_NOT_OK(accumulator->flush());
+                }
+                continue;
+            }
+
+            stats.convert.rows += static_cast<int64_t>(chunk->size());
+            if (!accumulator) {
+                ARROW_ASSIGN_OR_RAISE(*batch, ImportChunk(*chunk, outputSchema, result->client_properties));
+                stats.convert.bytes += arrow::util::TotalBufferSize(**batch);
+                return arrow::Status::OK();
+            }
+            ARROW_RETURN_NOT_OK(accumulator->append(*chunk));
+        }
+    }
+
+private:
+    std::unique_ptr<duckdb::QueryResult> result;
+    std::shared_ptr<arrow::Schema> outputSchema;
+    // Declared before the accumulator, so its builders free their buffers first
+    std::shared_ptr<RecyclingMemoryPool> arena;
+    std::unique_ptr<ChunkAccumulator> accumulator;
+    ProcessStats& stats;
+    // Runs once DuckDB has produced the last chunk
+    std::function<void()> onFinish;
+    bool finished = false;
+};
+
+// A profiler output file that no other process, or processor, writes to
+std::string ProfileScratchPath() {
+    static std::atomic<int> processors{0};
+#ifdef _WIN32
+    auto pid = static_cast<unsigned long>(GetCurrentProcessId());
+#else
+    auto pid = static_cast<unsigned long>(getpid());
+#endif
+    auto name = "duckarrowbridge_profile_" + std::to_string(pid) + "_" + std::to_string(processors++) + ".json";
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// Drops the processor's reference to an arena. Tables and batches still
+// holding its buffers keep it alive (see RetainArena), so it stops caching
+// and hands their buffers straight back to the memory pool as they are freed.
+void RetireRecyclingPool(std::shared_ptr<RecyclingMemoryPool>& pool) {
+    if (pool) {
+        pool->setMaxCachedBytes(0);
+        pool->ReleaseUnused();
+        pool.reset();
+    }
+}
+
+} // namespace
+
 DataProcessor::DataProcessor() {
     db = std::make_unique<duckdb::DuckDB>(nullptr);
     conn = std::make_unique<duckdb::Connection>(*db);
 }
 
+DataProcessor::~DataProcessor() {
+    RetireRecyclingPool(recyclingPool);
+    if (!profileScratch.empty()) {
+        std::error_code error;
+        std::filesystem::remove(profileScratch, error);
+    }
+}
+
 void DataProcessor::loadParquet(const std::string& filepath) {
+    loadParquet(std::vector<std::string>{filepath});
+}
+
+void DataProcessor::loadParquet(const std::vector<std::string>& filepaths) {
+    stats.load = StageStats();
+    StageTimer timer(stats.load);
     try {
-        std::string query = "CREATE TABLE tmp AS SELECT * FROM parquet_scan('" + filepath + "')"; // avoid it
+        // All files go into a single parquet_scan, which DuckDB parallelizes
+        // across files and row groups instead of one file at a time
+        std::string files = "[";
+        for (size_t i = 0; i < filepaths.size(); ++i) {
+            files += (i == 0 ? "" : ", ") + duckdb::Value(filepaths[i]).ToSQLString();
+        }
+        files += "]";
+        // Partition values are kept as VARCHAR rather than auto-cast, so the
+        // column types do not depend on which directories happen to exist
+        std::string scan = "parquet_scan(" + files +
+            (hivePartitioning ? ", hive_partitioning = true, hive_types_autocast = false" : "") + ")";
+
+        // As a view, the Parquet reader's projection and filter pushdown apply
+        // to every query over tmp and the data is copied only once, into Arrow
+        std::string query = loadMode == LoadMode::View
+            ? "CREATE OR REPLACE VIEW tmp AS SELECT * FROM " + scan
+            : "CREATE TABLE tmp AS SELECT * FROM " + scan; // avoid it
         auto result = conn->Query(query);
         if (result->HasError()) {
             throw std::runtime_error(result->GetError());
         }
+        // Before the footer queries below replace it as the last query
+        captureProfile(loadProfileJson);
+        loadParquetMetadata(files);
+        stats.load.rows = std::max<int64_t>(parquetRows, 0);
+        for (const auto& column : parquetColumnBytes) {
+            stats.load.bytes += column.second;
+        }
         /*result = conn->Query("SELECT * FROM tmp");
         while (true) {
             Sleep(500);
@@ -37,15 +320,236 @@ void DataProcessor::loadParquet(const std::string& filepath) {
     }
 }
 
+void DataProcessor::loadParquetMetadata(const std::string& files) {
+    // Only the footers are read. Without them the capacity hints are simply
+    // left off, so failures here are not errors
+    parquetRows = -1;
+    parquetColumnBytes.clear();
+    parquetDictionaryColumns.clear();
+    auto rows = conn->Query("SELECT sum(row_group_num_rows)::BIGINT FROM (SELECT DISTINCT file_name, row_group_id, "
+                            "row_group_num_rows FROM parquet_metadata(" + files + "))");
+    if (rows->HasError() || rows->RowCount() == 0 || rows->GetValue(0, 0).IsNull()) {
+        return;
+    }
+    parquetRows = rows->GetValue(0, 0).GetValue<int64_t>();
+
+    auto columns = conn->Query("SELECT path_in_schema, sum(total_uncompressed_size)::BIGINT FROM parquet_metadata(" +
+                               files + ") GROUP BY path_in_schema");
+    if (columns->HasError()) {
+        return;
+    }
+    for (duckdb::idx_t row = 0; row < columns->RowCount(); ++row) {
+        parquetColumnBytes[columns->GetValue(0, row).ToString()] = columns->GetValue(1, row).GetValue<int64_t>();
+    }
+
+    // A column chunk lists RLE_DICTIONARY (or PLAIN_DICTIONARY) among its
+    // encodings when its pages index a dictionary page
+    auto dictionaries = conn->Query("SELECT path_in_schema FROM parquet_metadata(" + files + ") GROUP BY "
+                                    "path_in_schema HAVING bool_and(encodings::VARCHAR LIKE '%DICTIONARY%')");
+    if (dictionaries->HasError()) {
+        return;
+    }
+    for (duckdb::idx_t row = 0; row < dictionaries->RowCount(); ++row) {
+        parquetDictionaryColumns.insert(dictionaries->GetValue(0, row).ToString());
+    }
+}
+
+std::unordered_set<std::string> DataProcessor::dictionaryColumnsFor(bool scansTmp) const {
+    if (!dictionaryColumns.empty()) {
+        return std::unordered_set<std::string>(dictionaryColumns.begin(), dictionaryColumns.end());
+    }
+    if (dictionaryEncoding && scansTmp) {
+        return parquetDictionaryColumns;
+    }
+    return std::unordered_set<std::string>();
+}
+
+void DataProcessor::hintCapacity(ChunkAccumulator& accumulator, duckdb::QueryResult& result, bool scansTmp) const {
+    // A materialized result knows its exact size. A streamed scan of tmp
+    // returns every row the Parquet footers list, unless it is filtered
+    if (result.type == duckdb::QueryResultType::MATERIALIZED_RESULT) {
+        accumulator.setExpectedRows(static_cast<int64_t>(result.Cast<duckdb::MaterializedQueryResult>().RowCount()));
+    } else if (scansTmp && predicates.empty() && parquetRows >= 0) {
+        accumulator.setExpectedRows(parquetRows);
+    }
+
+    // The uncompressed Parquet size of a string column approximates its
+    // Arrow payload (dictionary-encoded columns come out lower)
+    if (!scansTmp || parquetRows <= 0) {
+        return;
+    }
+    for (duckdb::idx_t col_idx = 0; col_idx < result.names.size(); ++col_idx) {
+        auto typeId = result.types[col_idx].id();
+        auto bytes = parquetColumnBytes.find(result.names[col_idx]);
+        if (bytes != parquetColumnBytes.end() &&
+            (typeId == duckdb::LogicalTypeId::VARCHAR || typeId == duckdb::LogicalTypeId::BLOB)) {
+            accumulator.setExpectedBytesPerRow(static_cast<int>(col_idx),
+                                               static_cast<double>(bytes->second) / parquetRows);
+        }
+    }
+}
+
+void DataProcessor::setLoadMode(LoadMode mode) {
+    loadMode = mode;
+}
+
+void DataProcessor::setHivePartitioning(bool enabled) {
+    hivePartitioning = enabled;
+}
+
+void DataProcessor::setExportMode(ExportMode mode) {
+    exportMode = mode;
+}
+
+void DataProcessor::setBatchSize(BatchSize size) {
+    batchSize = size;
+}
+
+void DataProcessor::setParallelConversion(bool enabled) {
+    parallelConversion = enabled;
+}
+
+void DataProcessor::setPipelined(bool enabled) {
+    pipelined = enabled;
+}
+
+void DataProcessor::setDictionaryEncoding(bool enabled) {
+    dictionaryEncoding = enabled;
+}
+
+void DataProcessor::setDictionaryColumns(std::vector<std::string> columns) {
+    dictionaryColumns = std::move(columns);
+}
+
+void DataProcessor::setMemoryPool(arrow::MemoryPool* pool) {
+    memoryPool = pool ? pool : arrow::default_memory_pool();
+    resetRecyclingPool();
+}
+
+void DataProcessor::setBufferRecycling(int64_t maxCachedBytes) {
+    recycledBytesLimit = std::max<int64_t>(maxCachedBytes, 0);
+    resetRecyclingPool();
+}
+
+void DataProcessor::resetRecyclingPool() {
+    RetireRecyclingPool(recyclingPool);
+    if (recycledBytesLimit > 0) {
+        recyclingPool = std::make_shared<RecyclingMemoryPool>(memoryPool, recycledBytesLimit);
+    }
+}
+
+void DataProcessor::setProfiling(bool enabled) {
+    profiling = enabled;
+    loadProfileJson.clear();
+    queryProfileJson.clear();
+
+    std::vector<std::string> pragmas;
+    if (enabled) {
+        // DuckDB prints every profile to the console unless it has a file to
+        // write to. The profiles are read back through the connection, so a
+        // scratch file, one per processor, takes that output
+        if (profileScratch.empty()) {
+            profileScratch = ProfileScratchPath();
+        }
+        pragmas = {"PRAGMA enable_profiling = 'json'",
+                   "PRAGMA profiling_output = " + duckdb::Value(profileScratch).ToSQLString()};
+    } else {
+        pragmas = {"PRAGMA disable_profiling"};
+    }
+    for (const auto& pragma : pragmas) {
+        auto result = conn->Query(pragma);
+        if (result->HasError()) {
+            std::cerr << "Failed to configure profiling: " << result->GetError() << std::endl;
+            profiling = false;
+            return;
+        }
+    }
+}
+
+const std::string& DataProcessor::loadProfile() const {
+    return loadProfileJson;
+}
+
+const std::string& DataProcessor::queryProfile() const {
+    return queryProfileJson;
+}
+
+void DataProcessor::captureProfile(std::string& profile) {
+    if (profiling) {
+        profile = conn->GetProfilingInformation(duckdb::ProfilerPrintFormat::JSON);
+    }
+}
+
+const ProcessStats& DataProcessor::processStats() const {
+    return stats;
+}
+
+void DataProcessor::setPerfCounters(bool enabled) {
+    perfCountersEnabled = enabled;
+}
+
+const PerfProfile& DataProcessor::perfCounters() const {
+    return perfProfile;
+}
+
+void DataProcessor::resetCallStats() {
+    auto load = stats.load;
+    stats = ProcessStats();
+    stats.load = load;
+    perfProfile.reset();
+}
+
+void DataProcessor::recordTableStats(const arrow::Table& table) {
+    stats.convert.bytes = arrow::util::TotalBufferSize(table);
+    stats.assemble.rows = table.num_rows();
+    stats.assemble.bytes = stats.convert.bytes;
+}
+
+arrow::MemoryPool* DataProcessor::builderPool() const {
+    return recyclingPool ? recyclingPool.get() : memoryPool;
+}
+
+void DataProcessor::setProjection(std::vector<std::string> columns) {
+    projection = std::move(columns);
+}
+
+void DataProcessor::addPredicate(Predicate predicate) {
+    predicates.push_back(std::move(predicate));
+}
+
+void DataProcessor::clearPredicates() {
+    predicates.clear();
+}
+
+std::string DataProcessor::scanQuery() const {
+    std::string query = "SELECT ";
+    if (projection.empty()) {
+        query += "*";
+    }
+    for (size_t i = 0; i < projection.size(); ++i) {
+        query += (i == 0 ? "" : ", ") + QuoteIdentifier(projection[i]);
+    }
+    query += " FROM tmp";
+
+    for (size_t i = 0; i < predicates.size(); ++i) {
+        query += i == 0 ? " WHERE " : " AND ";
+        query += QuoteIdentifier(predicates[i].column) + CompareOpToSQL(predicates[i].op) +
+                 predicates[i].value.ToSQLString();
+    }
+    return query;
+}
+
 std::shared_ptr<arrow::Table> DataProcessor::process() {
-    auto result = conn->Query("SELECT * FROM tmp");
+    resetCallStats();
+    StageTimer queryTimer(stats.query);
+    // Pipelining only overlaps anything if DuckDB is still executing while
+    // we convert, so that mode runs the query as a stream
+    auto result = pipelined ? conn->SendQuery(scanQuery()) : conn->Query(scanQuery());
+    queryTimer.stop();
+    if (result->type == duckdb::QueryResultType::MATERIALIZED_RESULT) {
+        stats.query.rows = static_cast<int64_t>(result->Cast<duckdb::MaterializedQueryResult>().RowCount());
+    }
     // auto result = conn->Query("SELECT * FROM '..\\data\\test_output_light.parquet'");
-    
-    ArrowSchema arrow_schema;
-    ArrowArray arrow_array;
-
-    //ToArrowSchema(&arrow_schema);
-    //ToArrowArray(&arrow_array);
 
     //auto result = conn->Query("SELECT * FROM 'C:\\Users\\stavr\\OneDrive\\Desktop\\DuckArrowBridge\\test_output.parquet' WHERE id > 10000000 AND id < 20000000 ");
     //auto result2 =  conn->Prepare("SELECT * FROM 'C:\\Users\\stavr\\OneDrive\\Desktop\\DuckArrowBridge\\test_output.parquet' WHERE id > 10000000 AND id < 20000000 ");
@@ -59,100 +563,142 @@ std::shared_ptr<arrow::Table> DataProcessor::process() {
         return nullptr;
     }
 
-    std::vector<std::shared_ptr<arrow::Array>> arrays;
-    std::vector<std::shared_ptr<arrow::Field>> fields;
+    auto table = exportMode == ExportMode::CDataInterface ? processWithCDataInterface(*result)
+                                                           : processWithBuilders(*result);
+    // A streamed query only finishes, and completes its profile, once fully fetched
+    captureProfile(queryProfileJson);
+    return table;
+}
 
-    // Use DuckToArrow
-    // PyBinding to pythnon package
-    // Test to win10
-    // See the chunk size 
-    while (true) {
-        auto chunk = result->Fetch(); // 
-        
-        if (!chunk || chunk->size() == 0) {
-            break;
+std::shared_ptr<arrow::RecordBatchReader> DataProcessor::stream(const std::string& query) {
+    resetCallStats();
+    StageTimer queryTimer(stats.query);
+    // SendQuery yields a StreamQueryResult: DuckDB produces chunks on demand
+    // instead of materializing the whole result first
+    auto result = conn->SendQuery(query);
+    queryTimer.stop();
+    if (result->HasError()) {
+        std::cerr << "Query failed: " << result->GetError() << std::endl;
+        return nullptr;
+    }
+
+    if (exportMode == ExportMode::CDataInterface) {
+        auto schema_result = ImportResultSchema(*result);
+        if (!schema_result.ok()) {
+            std::cerr << "Failed to import Arrow schema: " << schema_result.status().ToString() << std::endl;
+            return nullptr;
         }
+        return std::make_shared<QueryResultBatchReader>(std::move(result), *schema_result, nullptr, nullptr, stats,
+                                                        [this]() { captureProfile(queryProfileJson); });
+    }
 
-        /*duckdb::ArrowConverter();
-        duckdb::ArrowConverter();
-        duckdb::ClientProperties options();
-        duckdb::ArrowConverter::ToArrowArray(std::move(*chunk), &arrow_array, options);*/
-        //std::cout << "Chunk size: " << chunk->size() << std::endl;
-        //Sleep(500);
-        for (duckdb::idx_t col_idx = 0; col_idx < chunk->ColumnCount(); ++col_idx) {
-            auto& vector = chunk->data[col_idx];
-            auto logical_type = vector.GetType().id();
-            auto column_name = result->names[col_idx];
-
-           // std::cout << "Col Name: " << column_name << std::endl;
-            if (logical_type == duckdb::LogicalTypeId::INTEGER) {
-                arrow::Int32Builder builder;
-                for (duckdb::idx_t row_idx = 0; row_idx < chunk->size(); ++row_idx) {
-                    auto value = vector.GetValue(row_idx);
-                    if (value.IsNull()) {
-                        builder.AppendNull();
-                    } else {
-                        builder.Append(value.GetValue<int32_t>());
-                    }
-                }
+    auto scansTmp = query == scanQuery();
+    auto accumulator_result = ChunkAccumulator::Make(result->types, result->names, batchSize,
+                                                     dictionaryColumnsFor(scansTmp), builderPool());
+    if (!accumulator_result.ok()) {
+        std::cerr << "Failed to create Arrow builders: " << accumulator_result.status().ToString() << std::endl;
+        return nullptr;
+    }
+    auto accumulator = std::move(*accumulator_result);
+    accumulator->setParallel(parallelConversion);
+    accumulator->setPerfProfile(perfCountersEnabled ? &perfProfile : nullptr);
+    hintCapacity(*accumulator, *result, scansTmp);
+    auto schema = accumulator->schema();
+    return std::make_shared<QueryResultBatchReader>(std::move(result), schema, recyclingPool, std::move(accumulator),
+                                                    stats, [this]() { captureProfile(queryProfileJson); });
+}
 
-                std::shared_ptr<arrow::Array> array;
+bool DataProcessor::exportStream(const std::string& query, ArrowArrayStream* out) {
+    auto reader = stream(query);
+    if (!reader) {
+        return false;
+    }
 
-                // Check if the builder contains data before finishing
-                int32_t length;
-                length = builder.length();  // Check if there are values in the builder
+    // Ownership of the reader moves into the stream's private data and is
+    // dropped by its release callback
+    auto status = arrow::ExportRecordBatchReader(std::move(reader), out);
+    if (!status.ok()) {
+        std::cerr << "Failed to export Arrow stream: " << status.ToString() << std::endl;
+        return false;
+    }
+    return true;
+}
 
-                if (length > 0) {
-                    std::cout << "Number of elements in builder: " << length << std::endl;
-                }
-                else {
-                    std::cerr << "Builder is empty before Finish()" << std::endl;
-                }
+std::shared_ptr<arrow::Table> DataProcessor::processWithCDataInterface(duckdb::QueryResult& result) {
+    // DuckDB exports the schema once, then every chunk is handed over as a
+    // record batch whose buffers are owned by the ArrowArray release callback
+    auto schema_result = ImportResultSchema(result);
+    if (!schema_result.ok()) {
+        std::cerr << "Failed to import Arrow schema: " << schema_result.status().ToString() << std::endl;
+        return nullptr;
+    }
+    auto schema = *schema_result;
 
-                builder.Finish(&array);
-                arrays.push_back(array);
-                fields.push_back(arrow::field(column_name, arrow::int32()));
-            } 
-            else if (logical_type == duckdb::LogicalTypeId::VARCHAR) {
-                arrow::StringBuilder builder;
-                for (duckdb::idx_t row_idx = 0; row_idx < chunk->size(); ++row_idx) {
-                    auto value = vector.GetValue(row_idx);
-                    if (value.IsNull()) {
-                        builder.AppendNull();
-                    } else {
-                        builder.Append(value.GetValue<std::string>());
-                    }
-                }
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    auto status = ForEachChunk(result, pipelined, stats.fetch, [&](duckdb::DataChunk& chunk) -> arrow::Status {
+        StageTimer timer(stats.convert);
+        stats.convert.rows += static_cast<int64_t>(chunk.size());
+        // DuckDB's ArrowConverter handles the whole chunk at once, so its
+        // counts cannot be split by column
+        PerfScope perfScope(perfCountersEnabled ? &perfProfile : nullptr, "C Data Interface",
+                            static_cast<int64_t>(chunk.size()));
+        ARROW_ASSIGN_OR_RAISE(auto batch, ImportChunk(chunk, schema, result.client_properties));
+        batches.push_back(std::move(batch));
+        return arrow::Status::OK();
+    });
+    if (!status.ok()) {
+        std::cerr << "Failed to import Arrow record batch: " << status.ToString() << std::endl;
+        return nullptr;
+    }
 
-                std::shared_ptr<arrow::Array> array;
-                builder.Finish(&array);
-                arrays.push_back(array);
-                fields.push_back(arrow::field(column_name, arrow::utf8()));
-            } 
-            else if (logical_type == duckdb::LogicalTypeId::FLOAT) {
-                arrow::FloatBuilder builder;
-                for (duckdb::idx_t row_idx = 0; row_idx < chunk->size(); ++row_idx) {
-                    auto value = vector.GetValue(row_idx);
-                    if (value.IsNull()) {
-                        builder.AppendNull();
-                    } else {
-                        builder.Append(value.GetValue<float>());
-                    }
-                }
+    StageTimer assembleTimer(stats.assemble);
+    auto table_result = arrow::Table::FromRecordBatches(schema, batches);
+    assembleTimer.stop();
+    if (!table_result.ok()) {
+        std::cerr << "Failed to assemble Arrow table: " << table_result.status().ToString() << std::endl;
+        return nullptr;
+    }
+    recordTableStats(**table_result);
+    return *table_result;
+}
 
-                std::shared_ptr<arrow::Array> array;
-                builder.Finish(&array);
-                arrays.push_back(array);
-                fields.push_back(arrow::field(column_name, arrow::float32()));
-            } 
-            else {
-                std::cerr << "Unsupported data type in column: " << column_name << std::endl;
-                return nullptr;
-            }
-        }
+std::shared_ptr<arrow::Table> DataProcessor::processWithBuilders(duckdb::QueryResult& result) {
+    // The schema is fixed by the query, so it is resolved once before fetching
+    auto accumulator_result = ChunkAccumulator::Make(result.types, result.names, batchSize, dictionaryColumnsFor(true),
+                                                     builderPool());
+    if (!accumulator_result.ok()) {
+        std::cerr << "Failed to create Arrow builders: " << accumulator_result.status().ToString() << std::endl;
+        return nullptr;
     }
+    auto accumulator = std::move(*accumulator_result);
+    accumulator->setParallel(parallelConversion);
+    accumulator->setPerfProfile(perfCountersEnabled ? &perfProfile : nullptr);
+    hintCapacity(*accumulator, result, true);
 
-    auto schema = std::make_shared<arrow::Schema>(fields);
+    // Use DuckToArrow
+    // PyBinding to pythnon package
+    // Test to win10
+    // See the chunk size 
+    auto status = ForEachChunk(result, pipelined, stats.fetch, [&](duckdb::DataChunk& chunk) {
+        //std::cout << "Chunk size: " << chunk.size() << std::endl;
+        //Sleep(500);
+        StageTimer timer(stats.convert);
+        stats.convert.rows += static_cast<int64_t>(chunk.size());
+        return accumulator->append(chunk);
+    });
+    if (!status.ok()) {
+        std::cerr << status.message() << std::endl;
+        return nullptr;
+    }
 
-    return arrow::Table::Make(schema, arrays);
+    StageTimer assembleTimer(stats.assemble);
+    auto table_result = accumulator->finish();
+    assembleTimer.stop();
+    if (!table_result.ok()) {
+        std::cerr << "Failed to assemble Arrow table: " << table_result.status().ToString() << std::endl;
+        return nullptr;
+    }
+    auto table = recyclingPool ? RetainArena(*table_result, recyclingPool) : *table_result;
+    recordTableStats(*table);
+    return table;
 }
@@ -1,8 +1,12 @@
 #include <iostream>
 #include <string>
 #include "data_processor.hpp"
+#include "tracking_memory_pool.hpp"
+#include <arrow/c/bridge.h>
 
+#include <algorithm>
 #include <chrono>
+#include <sstream>
 
 // Function to print the data in an Apache Arrow Table
 void PrintArrowTable(const std::shared_ptr<arrow::Table>& table) {
@@ -17,50 +21,135 @@ void PrintArrowTable(const std::shared_ptr<arrow::Table>& table) {
     }
     std::cout << std::endl;
 
-    // Print row data
-    for (int64_t row_idx = 0; row_idx < table->num_rows(); ++row_idx) {
-        for (int col_idx = 0; col_idx < table->num_columns(); ++col_idx) {
-            auto column = table->column(col_idx);
-            auto array = column->chunk(0); // Assuming there's only one chunk for simplicity
-
-            switch (array->type_id()) {
-                case arrow::Type::INT32: {
-                    auto int_array = std::static_pointer_cast<arrow::Int32Array>(array);
-                    if (int_array->IsNull(row_idx)) {
-                        std::cout << "NULL";
-                    } else {
-                        std::cout << int_array->Value(row_idx);
+    // Print row data, chunk by chunk (all columns share the same chunk layout)
+    int num_chunks = table->num_columns() > 0 ? table->column(0)->num_chunks() : 0;
+    for (int chunk_idx = 0; chunk_idx < num_chunks; ++chunk_idx) {
+        int64_t chunk_rows = table->column(0)->chunk(chunk_idx)->length();
+        for (int64_t row_idx = 0; row_idx < chunk_rows; ++row_idx) {
+            for (int col_idx = 0; col_idx < table->num_columns(); ++col_idx) {
+                auto column = table->column(col_idx);
+                auto array = column->chunk(chunk_idx);
+
+                switch (array->type_id()) {
+                    case arrow::Type::INT32: {
+                        auto int_array = std::static_pointer_cast<arrow::Int32Array>(array);
+                        if (int_array->IsNull(row_idx)) {
+                            std::cout << "NULL";
+                        } else {
+                            std::cout << int_array->Value(row_idx);
+                        }
+                        break;
                     }
-                    break;
-                }
-                case arrow::Type::STRING: {
-                    auto string_array = std::static_pointer_cast<arrow::StringArray>(array);
-                    if (string_array->IsNull(row_idx)) {
-                        std::cout << "NULL";
-                    } else {
-                        std::cout << string_array->GetString(row_idx);
+                    case arrow::Type::STRING: {
+                        auto string_array = std::static_pointer_cast<arrow::StringArray>(array);
+                        if (string_array->IsNull(row_idx)) {
+                            std::cout << "NULL";
+                        } else {
+                            std::cout << string_array->GetString(row_idx);
+                        }
+                        break;
                     }
-                    break;
-                }
-                case arrow::Type::FLOAT: {
-                    auto float_array = std::static_pointer_cast<arrow::FloatArray>(array);
-                    if (float_array->IsNull(row_idx)) {
-                        std::cout << "NULL";
-                    } else {
-                        std::cout << float_array->Value(row_idx);
+                    case arrow::Type::FLOAT: {
+                        auto float_array = std::static_pointer_cast<arrow::FloatArray>(array);
+                        if (float_array->IsNull(row_idx)) {
+                            std::cout << "NULL";
+                        } else {
+                            std::cout << float_array->Value(row_idx);
+                        }
+                        break;
+                    }
+                    default: {
+                        auto scalar = array->GetScalar(row_idx);
+                        if (!scalar.ok()) {
+                            std::cout << "Unsupported type";
+                        } else if (!(*scalar)->is_valid) {
+                            std::cout << "NULL";
+                        } else {
+                            std::cout << (*scalar)->ToString();
+                        }
+                        break;
                     }
-                    break;
                 }
-                default:
-                    std::cout << "Unsupported type";
-                    break;
+                std::cout << "\t";
             }
-            std::cout << "\t";
+            std::cout << std::endl;
         }
-        std::cout << std::endl;
     }
 }
 
+// Consume the result batch by batch through DataProcessor::stream, or through
+// the ArrowArrayStream from exportStream as an external consumer would
+int StreamBatches(DataProcessor& processor, bool viaCStream) {
+    auto start = std::chrono::high_resolution_clock::now();
+    std::shared_ptr<arrow::RecordBatchReader> reader;
+    if (viaCStream) {
+        ArrowArrayStream c_stream;
+        if (processor.exportStream(processor.scanQuery(), &c_stream)) {
+            auto reader_result = arrow::ImportRecordBatchReader(&c_stream);
+            if (reader_result.ok()) {
+                reader = *reader_result;
+            }
+        }
+    } else {
+        reader = processor.stream(processor.scanQuery());
+    }
+    if (!reader) {
+        std::cerr << "Failed to stream data." << std::endl;
+        return 1;
+    }
+
+    int64_t rows = 0;
+    int64_t batches = 0;
+    std::shared_ptr<arrow::RecordBatch> batch;
+    while (true) {
+        auto status = reader->ReadNext(&batch);
+        if (!status.ok()) {
+            std::cerr << "Failed to stream data: " << status.ToString() << std::endl;
+            return 1;
+        }
+        if (!batch) {
+            break;
+        }
+        rows += batch->num_rows();
+        ++batches;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "Time taken by stream: " << elapsed.count() << " seconds." << std::endl;
+    std::cout << "Streamed " << rows << " rows in " << batches << " batches." << std::endl;
+    return 0;
+}
+
+// Resolves --allocator; falls back to Arrow's default pool when the
+// allocator was not compiled into the Arrow build
+arrow::MemoryPool* SelectMemoryPool(const std::string& name) {
+    arrow::MemoryPool* pool = nullptr;
+    arrow::Status status;
+    if (name == "system") {
+        pool = arrow::system_memory_pool();
+    } else if (name == "jemalloc") {
+        status = arrow::jemalloc_memory_pool(&pool);
+    } else if (name == "mimalloc") {
+        status = arrow::mimalloc_memory_pool(&pool);
+    } else {
+        status = arrow::Status::Invalid("Unknown allocator: ", name);
+    }
+
+    if (!status.ok()) {
+        std::cerr << status.ToString() << ". Using " << arrow::default_memory_pool()->backend_name() << "." << std::endl;
+        return arrow::default_memory_pool();
+    }
+    return pool;
+}
+
+void PrintMemoryStats(const TrackingMemoryPool& pool) {
+    auto stats = pool.stats();
+    std::cout << "Memory (" << pool.backend_name() << "): " << stats.bytesAllocated << " bytes allocated, "
+              << stats.peakBytes << " peak, " << stats.liveBytes << " live, " << stats.allocations << " allocations, "
+              << stats.reallocations << " reallocations, " << stats.frees << " frees." << std::endl;
+}
+
 int main(int argc, char* argv[]) {
      /*if (argc < 2) {
          std::cerr << "Usage: " << argv[0] << " <parquet_file>" << std::endl;
@@ -69,29 +158,179 @@ int main(int argc, char* argv[]) {
 
     // TODO: Add Check method for parquet file and input via json file 
     // std::string filepath = argv[1];
-    std::string filepath = "..\\data\\test_output_light.parquet";
+    std::vector<std::string> filepaths;
    
     bool printTable = false;
+    bool streamBatches = false;
+    bool exportCStream = false;
+    LoadMode loadMode = LoadMode::Table;
+    ExportMode exportMode = ExportMode::Builder;
+    BatchSize batchSize;
+    std::vector<std::string> columns;
+    bool hivePartitioning = false;
+    bool parallelConversion = false;
+    bool pipelined = false;
+    bool dictionaryEncoding = false;
+    std::vector<std::string> dictionaryColumns;
+    bool trackMemory = false;
+    bool printStats = false;
+    bool profile = false;
+    bool perfCounters = false;
+    int64_t recycleBytes = 0;
+    int repeat = 1;
+    arrow::MemoryPool* memoryPool = arrow::default_memory_pool();
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--enable-print" /*|| arg == "-e"*/) {
             printTable = true;  // Set the flag to true if found
         }
+        else if (arg == "--stream") {
+            streamBatches = true;
+        }
+        else if (arg == "--export-stream") {
+            streamBatches = true;
+            exportCStream = true;
+        }
+        else if (arg.rfind("--input=", 0) == 0) {
+            filepaths.push_back(arg.substr(std::string("--input=").size()));
+        }
+        else if (arg == "--hive") {
+            hivePartitioning = true;
+        }
+        else if (arg == "--lazy") {
+            loadMode = LoadMode::View;
+        }
+        else if (arg == "--parallel") {
+            parallelConversion = true;
+        }
+        else if (arg == "--pipeline") {
+            pipelined = true;
+        }
+        else if (arg == "--dictionary") {
+            dictionaryEncoding = true;
+        }
+        else if (arg.rfind("--dictionary=", 0) == 0) {
+            std::stringstream list(arg.substr(std::string("--dictionary=").size()));
+            std::string column;
+            while (std::getline(list, column, ',')) {
+                dictionaryColumns.push_back(column);
+            }
+        }
+        else if (arg == "--c-data") {
+            exportMode = ExportMode::CDataInterface;
+        }
+        else if (arg.rfind("--columns=", 0) == 0) {
+            std::stringstream list(arg.substr(std::string("--columns=").size()));
+            std::string column;
+            while (std::getline(list, column, ',')) {
+                columns.push_back(column);
+            }
+        }
+        else if (arg.rfind("--allocator=", 0) == 0) {
+            memoryPool = SelectMemoryPool(arg.substr(std::string("--allocator=").size()));
+        }
+        else if (arg == "--perf-counters") {
+            perfCounters = true;
+        }
+        else if (arg == "--profile") {
+            profile = true;
+        }
+        else if (arg == "--stats") {
+            printStats = true;
+        }
+        else if (arg == "--track-memory") {
+            trackMemory = true;
+        }
+        else if (arg.rfind("--recycle-buffers=", 0) == 0) {
+            recycleBytes = std::stoll(arg.substr(std::string("--recycle-buffers=").size()));
+        }
+        else if (arg.rfind("--repeat=", 0) == 0) {
+            repeat = std::max(std::stoi(arg.substr(std::string("--repeat=").size())), 1);
+        }
+        else if (arg.rfind("--batch-rows=", 0) == 0) {
+            batchSize.rows = std::stoll(arg.substr(std::string("--batch-rows=").size()));
+        }
+        else if (arg.rfind("--batch-bytes=", 0) == 0) {
+            batchSize.bytes = std::stoll(arg.substr(std::string("--batch-bytes=").size()));
+        }
+    }
+
+    if (filepaths.empty()) {
+        filepaths.push_back("..\\data\\test_output_light.parquet");
     }
 
+    // Declared before the processor so it outlives every table it allocated
+    TrackingMemoryPool trackingPool(memoryPool);
+
     DataProcessor processor;
-    processor.loadParquet(filepath);
+    processor.setMemoryPool(trackMemory ? &trackingPool : memoryPool);
+    processor.setBufferRecycling(recycleBytes);
+    processor.setLoadMode(loadMode);
+    processor.setHivePartitioning(hivePartitioning);
+    processor.setExportMode(exportMode);
+    processor.setBatchSize(batchSize);
+    processor.setProjection(columns);
+    processor.setParallelConversion(parallelConversion);
+    processor.setPipelined(pipelined);
+    processor.setDictionaryEncoding(dictionaryEncoding);
+    processor.setDictionaryColumns(dictionaryColumns);
+    processor.setProfiling(profile);
+    processor.setPerfCounters(perfCounters);
+    if (perfCounters && !PerfCountersAvailable()) {
+        std::cerr << "Hardware counters are unavailable (Linux perf_event_open); counts will be zero." << std::endl;
+    }
+    processor.loadParquet(filepaths);
+    if (profile) {
+        std::cout << "Load profile: " << processor.loadProfile() << std::endl;
+    }
 
-     // Start time point
-    auto start = std::chrono::high_resolution_clock::now();
-    std::shared_ptr<arrow::Table> table = processor.process();
-    auto end = std::chrono::high_resolution_clock::now();
+    if (streamBatches) {
+        trackingPool.reset();
+        auto status = StreamBatches(processor, exportCStream);
+        if (trackMemory) {
+            PrintMemoryStats(trackingPool);
+        }
+        if (printStats) {
+            std::cout << "Stages: " << processor.processStats().toJson() << std::endl;
+        }
+        if (profile) {
+            std::cout << "Query profile: " << processor.queryProfile() << std::endl;
+        }
+        if (perfCounters) {
+            std::cout << "Perf counters: " << processor.perfCounters().toJson() << std::endl;
+        }
+        return status;
+    }
 
-    // Calculate the duration
-    std::chrono::duration<double> elapsed = end - start;
+    std::shared_ptr<arrow::Table> table;
+    for (int run = 0; run < repeat; ++run) {
+        // Release the previous result first so its buffers can be recycled
+        table.reset();
+        // Count only what the process() call itself allocates
+        trackingPool.reset();
+        // Start time point
+        auto start = std::chrono::high_resolution_clock::now();
+        table = processor.process();
+        auto end = std::chrono::high_resolution_clock::now();
 
-    // Output the elapsed time in seconds
-    std::cout << "Time taken by process function: " << elapsed.count() << " seconds." << std::endl;
+        // Calculate the duration
+        std::chrono::duration<double> elapsed = end - start;
+
+        // Output the elapsed time in seconds
+        std::cout << "Time taken by process function: " << elapsed.count() << " seconds." << std::endl;
+        if (trackMemory) {
+            PrintMemoryStats(trackingPool);
+        }
+        if (printStats) {
+            std::cout << "Stages: " << processor.processStats().toJson() << std::endl;
+        }
+        if (profile) {
+            std::cout << "Query profile: " << processor.queryProfile() << std::endl;
+        }
+        if (perfCounters) {
+            std::cout << "Perf counters: " << processor.perfCounters().toJson() << std::endl;
+        }
+    }
 
     if (table) {
         std::cout << "Successfully processed data into Arrow Table." << std::endl;
@@ -0,0 +1,178 @@
+#include "perf_counters.hpp"
+#include <sstream>
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+#ifdef __linux__
+// Events of the hardware group, in the order read() returns them
+constexpr uint64_t HardwareEvents[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                       PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+constexpr size_t HardwareEventCount = sizeof(HardwareEvents) / sizeof(HardwareEvents[0]);
+
+// Counts `config` for the calling thread on any CPU, user space only
+int OpenEvent(uint32_t type, uint64_t config, int groupFd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = groupFd == -1 && type == PERF_TYPE_HARDWARE ? PERF_FORMAT_GROUP : 0;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+
+uint64_t ReadCounter(int fd) {
+    uint64_t value = 0;
+    if (fd < 0 || ::read(fd, &value, sizeof(value)) != sizeof(value)) {
+        return 0;
+    }
+    return value;
+}
+#endif
+
+void AppendCounts(std::ostringstream& json, const std::string& key, const PerfCounts& counts) {
+    auto perRow = [&](uint64_t value) {
+        return counts.rows > 0 ? static_cast<double>(value) / static_cast<double>(counts.rows) : 0.0;
+    };
+    json << "\"" << key << "\": {\"rows\": " << counts.rows << ", \"cycles\": " << counts.cycles
+         << ", \"instructions\": " << counts.instructions << ", \"cache_misses\": " << counts.cacheMisses
+         << ", \"branch_misses\": " << counts.branchMisses << ", \"page_faults\": " << counts.pageFaults
+         << ", \"ipc\": "
+         << (counts.cycles > 0 ? static_cast<double>(counts.instructions) / static_cast<double>(counts.cycles) : 0.0)
+         << ", \"cycles_per_row\": " << perRow(counts.cycles) << ", \"cache_misses_per_row\": "
+         << perRow(counts.cacheMisses) << ", \"branch_misses_per_row\": " << perRow(counts.branchMisses) << "}";
+}
+
+} // namespace
+
+PerfCounts& PerfCounts::operator+=(const PerfCounts& other) {
+    cycles += other.cycles;
+    instructions += other.instructions;
+    cacheMisses += other.cacheMisses;
+    branchMisses += other.branchMisses;
+    pageFaults += other.pageFaults;
+    rows += other.rows;
+    return *this;
+}
+
+ThreadPerfCounters& ThreadPerfCounters::current() {
+    thread_local ThreadPerfCounters counters;
+    return counters;
+}
+
+ThreadPerfCounters::ThreadPerfCounters() {
+#ifdef __linux__
+    for (auto event : HardwareEvents) {
+        int fd = OpenEvent(PERF_TYPE_HARDWARE, event, hardwareFds.empty() ? -1 : hardwareFds[0]);
+        if (fd < 0) {
+            // A partial group would shift the values read() returns
+            for (int open : hardwareFds) {
+                close(open);
+            }
+            hardwareFds.clear();
+            break;
+        }
+        hardwareFds.push_back(fd);
+    }
+    pageFaultFd = OpenEvent(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, -1);
+#endif
+}
+
+ThreadPerfCounters::~ThreadPerfCounters() {
+#ifdef __linux__
+    for (int fd : hardwareFds) {
+        close(fd);
+    }
+    if (pageFaultFd >= 0) {
+        close(pageFaultFd);
+    }
+#endif
+}
+
+bool ThreadPerfCounters::available() const {
+    return !hardwareFds.empty() || pageFaultFd >= 0;
+}
+
+PerfCounts ThreadPerfCounters::read() const {
+    PerfCounts counts;
+#ifdef __linux__
+    if (!hardwareFds.empty()) {
+        // PERF_FORMAT_GROUP: the number of events, then one value per event
+        uint64_t values[1 + HardwareEventCount] = {};
+        if (::read(hardwareFds[0], values, sizeof(values)) == sizeof(values) && values[0] == HardwareEventCount) {
+            counts.cycles = values[1];
+            counts.instructions = values[2];
+            counts.cacheMisses = values[3];
+            counts.branchMisses = values[4];
+        }
+    }
+    counts.pageFaults = ReadCounter(pageFaultFd);
+#endif
+    return counts;
+}
+
+void PerfProfile::add(const std::string& key, const PerfCounts& delta) {
+    std::lock_guard<std::mutex> lock(mutex);
+    counts[key] += delta;
+}
+
+void PerfProfile::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    counts.clear();
+}
+
+std::map<std::string, PerfCounts> PerfProfile::totals() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counts;
+}
+
+std::string PerfProfile::toJson() const {
+    auto snapshot = totals();
+    std::ostringstream json;
+    json << "{";
+    for (auto it = snapshot.begin(); it != snapshot.end(); ++it) {
+        if (it != snapshot.begin()) {
+            json << ", ";
+        }
+        AppendCounts(json, it->first, it->second);
+    }
+    json << "}";
+    return json.str();
+}
+
+PerfScope::PerfScope(PerfProfile* profile, const std::string& key, int64_t rows)
+    : profile(profile), key(profile ? key : std::string()), rows(rows) {
+    if (profile) {
+        start = ThreadPerfCounters::current().read();
+    }
+}
+
+void PerfScope::stop() {
+    if (!profile) {
+        return;
+    }
+    auto end = ThreadPerfCounters::current().read();
+    PerfCounts delta;
+    delta.cycles = end.cycles - start.cycles;
+    delta.instructions = end.instructions - start.instructions;
+    delta.cacheMisses = end.cacheMisses - start.cacheMisses;
+    delta.branchMisses = end.branchMisses - start.branchMisses;
+    delta.pageFaults = end.pageFaults - start.pageFaults;
+    delta.rows = rows;
+    profile->add(key, delta);
+    profile = nullptr;
+}
+
+bool PerfCountersAvailable() {
+    return ThreadPerfCounters::current().available();
+}
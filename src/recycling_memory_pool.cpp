@@ -0,0 +1,219 @@
+#include "recycling_memory_pool.hpp"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <arrow/api.h>
+
+
+namespace {
+
+// Buffers smaller than this are not worth a free-list round trip
+constexpr int kMinSizeClass = 6;
+// Larger ones are rare enough to go straight to the target pool
+constexpr int kMaxSizeClass = 40;
+
+int64_t ClassBytes(int sizeClass) {
+    return int64_t(1) << sizeClass;
+}
+
+// A view of a whole arena buffer that also holds the arena. The buffer goes
+// back to the arena before this reference to it is dropped
+class ArenaBuffer : public arrow::Buffer {
+public:
+    ArenaBuffer(std::shared_ptr<arrow::Buffer> buffer, std::shared_ptr<RecyclingMemoryPool> arena)
+        : arrow::Buffer(buffer, 0, buffer->size()), arena(std::move(arena)) {
+    }
+    ~ArenaBuffer() override {
+        parent_.reset();
+    }
+private:
+    std::shared_ptr<RecyclingMemoryPool> arena;
+};
+
+// Rewraps the buffers of arrays, once per buffer and array, so shared
+// dictionaries stay shared and buffer sizes are not counted twice
+class ArenaRetainer {
+public:
+    explicit ArenaRetainer(std::shared_ptr<RecyclingMemoryPool> arena) : arena(std::move(arena)) {
+    }
+
+    std::shared_ptr<arrow::ArrayData> retain(const std::shared_ptr<arrow::ArrayData>& data) {
+        if (!data) {
+            return data;
+        }
+        auto& retained = arrays[data.get()];
+        if (!retained) {
+            retained = std::make_shared<arrow::ArrayData>(*data);
+            for (auto& buffer : retained->buffers) {
+                buffer = retain(buffer);
+            }
+            for (auto& child : retained->child_data) {
+                child = retain(child);
+            }
+            retained->dictionary = retain(retained->dictionary);
+        }
+        return retained;
+    }
+
+    std::shared_ptr<arrow::Array> retain(const std::shared_ptr<arrow::Array>& array) {
+        return arrow::MakeArray(retain(array->data()));
+    }
+private:
+    std::shared_ptr<arrow::Buffer> retain(const std::shared_ptr<arrow::Buffer>& buffer) {
+        if (!buffer) {
+            return buffer;
+        }
+        auto& retained = buffers[buffer.get()];
+        if (!retained) {
+            retained = std::make_shared<ArenaBuffer>(buffer, arena);
+        }
+        return retained;
+    }
+
+    std::shared_ptr<RecyclingMemoryPool> arena;
+    std::unordered_map<const arrow::ArrayData*, std::shared_ptr<arrow::ArrayData>> arrays;
+    std::unordered_map<const arrow::Buffer*, std::shared_ptr<arrow::Buffer>> buffers;
+};
+
+} // namespace
+
+RecyclingMemoryPool::RecyclingMemoryPool(arrow::MemoryPool* target, int64_t maxCachedBytes)
+    : target(target), maxCachedBytes(maxCachedBytes), freeLists(kMaxSizeClass + 1) {
+}
+
+RecyclingMemoryPool::~RecyclingMemoryPool() {
+    ReleaseUnused();
+}
+
+int RecyclingMemoryPool::SizeClass(int64_t size) {
+    int sizeClass = kMinSizeClass;
+    while (ClassBytes(sizeClass) < size) {
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+bool RecyclingMemoryPool::Recyclable(int64_t size, int64_t alignment) {
+    // Size 0 maps to the target's shared zero-size area and must go back there
+    return size > 0 && size <= ClassBytes(kMaxSizeClass) && alignment == arrow::kDefaultBufferAlignment;
+}
+
+arrow::Status RecyclingMemoryPool::Allocate(int64_t size, int64_t alignment, uint8_t** out) {
+    if (!Recyclable(size, alignment)) {
+        return target->Allocate(size, alignment, out);
+    }
+
+    auto sizeClass = SizeClass(size);
+    auto bytes = ClassBytes(sizeClass);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& freeList = freeLists[sizeClass];
+        if (!freeList.empty()) {
+            *out = freeList.back();
+            freeList.pop_back();
+            cached -= bytes;
+            ++reused;
+        } else {
+            *out = nullptr;
+        }
+    }
+    if (!*out) {
+        ARROW_RETURN_NOT_OK(target->Allocate(bytes, alignment, out));
+    }
+
+    auto live = liveBytes.fetch_add(bytes) + bytes;
+    auto peak = peakBytes.load();
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live)) {
+    }
+    totalBytes += bytes;
+    ++allocations;
+    return arrow::Status::OK();
+}
+
+arrow::Status RecyclingMemoryPool::Reallocate(int64_t oldSize, int64_t newSize, int64_t alignment, uint8_t** ptr) {
+    auto oldRecyclable = Recyclable(oldSize, alignment);
+    auto newRecyclable = Recyclable(newSize, alignment);
+    if (!oldRecyclable && !newRecyclable) {
+        return target->Reallocate(oldSize, newSize, alignment, ptr);
+    }
+    if (oldRecyclable && newRecyclable && SizeClass(oldSize) == SizeClass(newSize)) {
+        // The class already has room for the new size
+        return arrow::Status::OK();
+    }
+
+    uint8_t* moved = nullptr;
+    ARROW_RETURN_NOT_OK(Allocate(newSize, alignment, &moved));
+    std::memcpy(moved, *ptr, static_cast<size_t>(std::min(oldSize, newSize)));
+    Free(*ptr, oldSize, alignment);
+    *ptr = moved;
+    return arrow::Status::OK();
+}
+
+void RecyclingMemoryPool::Free(uint8_t* buffer, int64_t size, int64_t alignment) {
+    if (!Recyclable(size, alignment)) {
+        target->Free(buffer, size, alignment);
+        return;
+    }
+
+    auto sizeClass = SizeClass(size);
+    auto bytes = ClassBytes(sizeClass);
+    liveBytes.fetch_sub(bytes);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cached + bytes <= maxCachedBytes) {
+            freeLists[sizeClass].push_back(buffer);
+            cached += bytes;
+            return;
+        }
+    }
+    target->Free(buffer, bytes, alignment);
+}
+
+void RecyclingMemoryPool::ReleaseUnused() {
+    std::vector<std::vector<uint8_t*>> released(freeLists.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        released.swap(freeLists);
+        cached = 0;
+    }
+    for (size_t sizeClass = 0; sizeClass < released.size(); ++sizeClass) {
+        for (auto buffer : released[sizeClass]) {
+            target->Free(buffer, ClassBytes(static_cast<int>(sizeClass)), arrow::kDefaultBufferAlignment);
+        }
+    }
+    target->ReleaseUnused();
+}
+
+void RecyclingMemoryPool::setMaxCachedBytes(int64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxCachedBytes = bytes;
+}
+
+int64_t RecyclingMemoryPool::cachedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cached;
+}
+
+std::shared_ptr<arrow::Table> RetainArena(const std::shared_ptr<arrow::Table>& table,
+                                          const std::shared_ptr<RecyclingMemoryPool>& arena) {
+    ArenaRetainer retainer(arena);
+    arrow::ChunkedArrayVector columns;
+    for (const auto& column : table->columns()) {
+        arrow::ArrayVector chunks;
+        for (const auto& chunk : column->chunks()) {
+            chunks.push_back(retainer.retain(chunk));
+        }
+        columns.push_back(std::make_shared<arrow::ChunkedArray>(std::move(chunks), column->type()));
+    }
+    return arrow::Table::Make(table->schema(), std::move(columns), table->num_rows());
+}
+
+std::shared_ptr<arrow::RecordBatch> RetainArena(const std::shared_ptr<arrow::RecordBatch>& batch,
+                                                const std::shared_ptr<RecyclingMemoryPool>& arena) {
+    ArenaRetainer retainer(arena);
+    arrow::ArrayVector columns;
+    for (const auto& column : batch->columns()) {
+        columns.push_back(retainer.retain(column));
+    }
+    return arrow::RecordBatch::Make(batch->schema(), batch->num_rows(), std::move(columns));
+}
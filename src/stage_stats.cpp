@@ -0,0 +1,68 @@
+#include "stage_stats.hpp"
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+
+namespace {
+
+double ProcessCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+    auto ticks = [](const FILETIME& time) {
+        return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    // FILETIME counts 100 ns intervals
+    return static_cast<double>(ticks(kernel) + ticks(user)) * 1e-7;
+#else
+    timespec time;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0) {
+        return 0.0;
+    }
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+#endif
+}
+
+void AppendStage(std::ostringstream& json, const char* name, const StageStats& stage) {
+    json << "\"" << name << "\": {\"wall_seconds\": " << stage.wallSeconds << ", \"cpu_seconds\": " << stage.cpuSeconds
+         << ", \"rows\": " << stage.rows << ", \"bytes\": " << stage.bytes << "}";
+}
+
+} // namespace
+
+std::string ProcessStats::toJson() const {
+    std::ostringstream json;
+    json << "{";
+    AppendStage(json, "load", load);
+    json << ", ";
+    AppendStage(json, "query", query);
+    json << ", ";
+    AppendStage(json, "fetch", fetch);
+    json << ", ";
+    AppendStage(json, "convert", convert);
+    json << ", ";
+    AppendStage(json, "assemble", assemble);
+    json << "}";
+    return json.str();
+}
+
+StageTimer::StageTimer(StageStats& stage)
+    : stage(&stage), wallStart(std::chrono::steady_clock::now()), cpuStart(ProcessCpuSeconds()) {
+}
+
+void StageTimer::stop() {
+    if (!stage) {
+        return;
+    }
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallStart;
+    stage->wallSeconds += wall.count();
+    stage->cpuSeconds += ProcessCpuSeconds() - cpuStart;
+    stage = nullptr;
+}
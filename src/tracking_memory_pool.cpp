@@ -0,0 +1,72 @@
+#include "tracking_memory_pool.hpp"
+
+
+TrackingMemoryPool::TrackingMemoryPool(arrow::MemoryPool* target) : target(target) {
+}
+
+arrow::Status TrackingMemoryPool::grow(int64_t bytes) {
+    auto live = liveBytes.fetch_add(bytes) + bytes;
+    auto cap = limit.load();
+    if (cap > 0 && bytes > 0 && live > cap) {
+        liveBytes.fetch_sub(bytes);
+        return arrow::Status::OutOfMemory("Allocation of ", bytes, " bytes exceeds the memory limit of ", cap,
+                                          " bytes");
+    }
+
+    auto peak = peakBytes.load();
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live)) {
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Status TrackingMemoryPool::Allocate(int64_t size, int64_t alignment, uint8_t** out) {
+    ARROW_RETURN_NOT_OK(grow(size));
+    auto status = target->Allocate(size, alignment, out);
+    if (!status.ok()) {
+        liveBytes.fetch_sub(size);
+        return status;
+    }
+    ++allocations;
+    totalBytes += size;
+    return arrow::Status::OK();
+}
+
+arrow::Status TrackingMemoryPool::Reallocate(int64_t oldSize, int64_t newSize, int64_t alignment, uint8_t** ptr) {
+    auto delta = newSize - oldSize;
+    ARROW_RETURN_NOT_OK(grow(delta));
+    auto status = target->Reallocate(oldSize, newSize, alignment, ptr);
+    if (!status.ok()) {
+        liveBytes.fetch_sub(delta);
+        return status;
+    }
+    ++reallocations;
+    if (delta > 0) {
+        totalBytes += delta;
+    }
+    return arrow::Status::OK();
+}
+
+void TrackingMemoryPool::Free(uint8_t* buffer, int64_t size, int64_t alignment) {
+    target->Free(buffer, size, alignment);
+    liveBytes.fetch_sub(size);
+    ++frees;
+}
+
+void TrackingMemoryPool::reset() {
+    peakBytes = liveBytes.load();
+    totalBytes = 0;
+    allocations = 0;
+    reallocations = 0;
+    frees = 0;
+}
+
+MemoryStats TrackingMemoryPool::stats() const {
+    MemoryStats stats;
+    stats.bytesAllocated = totalBytes.load();
+    stats.peakBytes = peakBytes.load();
+    stats.liveBytes = liveBytes.load();
+    stats.allocations = allocations.load();
+    stats.reallocations = reallocations.load();
+    stats.frees = frees.load();
+    return stats;
+}
@@ -0,0 +1,431 @@
+#include "column_converter.hpp"
+#include "duckdb.hpp"
+#include <arrow/api.h>
+#include <arrow/c/bridge.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+// Converts DuckDB results through ChunkAccumulator, the path process() takes
+// in builder mode, and checks the Arrow arrays it produces. Exits non-zero if
+// any check fails.
+
+namespace {
+
+int failures = 0;
+
+void Check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+arrow::Result<std::shared_ptr<arrow::Array>> ConvertChunk(duckdb::DataChunk& chunk) {
+    duckdb::vector<std::string> names;
+    for (duckdb::idx_t col_idx = 0; col_idx < chunk.ColumnCount(); ++col_idx) {
+        names.push_back("c" + std::to_string(col_idx));
+    }
+    ARROW_ASSIGN_OR_RAISE(auto accumulator, ChunkAccumulator::Make(chunk.GetTypes(), names));
+    ARROW_RETURN_NOT_OK(accumulator->append(chunk));
+    ARROW_ASSIGN_OR_RAISE(auto table, accumulator->finish());
+    return arrow::Concatenate(table->column(0)->chunks());
+}
+
+arrow::Result<std::shared_ptr<arrow::Array>> ConvertQuery(duckdb::Connection& conn, const std::string& query) {
+    auto result = conn.Query(query);
+    if (result->HasError()) {
+        return arrow::Status::ExecutionError(result->GetError());
+    }
+    ARROW_ASSIGN_OR_RAISE(auto accumulator, ChunkAccumulator::Make(result->types, result->names));
+    while (auto chunk = result->Fetch()) {
+        if (chunk->size() == 0) {
+            break;
+        }
+        ARROW_RETURN_NOT_OK(accumulator->append(*chunk));
+    }
+    ARROW_ASSIGN_OR_RAISE(auto table, accumulator->finish());
+    return arrow::Concatenate(table->column(0)->chunks());
+}
+
+// The same result through DuckDB's own Arrow export, which is what process()
+// returns in C Data Interface mode
+arrow::Result<std::shared_ptr<arrow::Array>> ConvertQueryCData(duckdb::Connection& conn, const std::string& query) {
+    auto result = conn.Query(query);
+    if (result->HasError()) {
+        return arrow::Status::ExecutionError(result->GetError());
+    }
+    ArrowSchema arrow_schema;
+    duckdb::ArrowConverter::ToArrowSchema(&arrow_schema, result->types, result->names, result->client_properties);
+    ARROW_ASSIGN_OR_RAISE(auto schema, arrow::ImportSchema(&arrow_schema));
+    arrow::ArrayVector arrays;
+    while (auto chunk = result->Fetch()) {
+        if (chunk->size() == 0) {
+            break;
+        }
+        ArrowArray arrow_array;
+        duckdb::ArrowConverter::ToArrowArray(*chunk, &arrow_array, result->client_properties);
+        ARROW_ASSIGN_OR_RAISE(auto batch, arrow::ImportRecordBatch(&arrow_array, schema));
+        arrays.push_back(batch->column(0));
+    }
+    return arrow::Concatenate(arrays);
+}
+
+void CheckMatchesCData(duckdb::Connection& conn, const std::string& query, const std::string& name) {
+    auto ours = ConvertQuery(conn, query);
+    auto theirs = ConvertQueryCData(conn, query);
+    Check(ours.ok(), name + " converts: " + ours.status().ToString());
+    Check(theirs.ok(), name + " exports: " + theirs.status().ToString());
+    if (!ours.ok() || !theirs.ok()) {
+        return;
+    }
+    // DuckDB tags TIMESTAMP_TZ with the client time zone rather than UTC;
+    // the layout is the same, so its array is viewed as ours
+    auto expected = (*theirs)->View((*ours)->type());
+    Check(expected.ok(), name + " has DuckDB's layout: " + expected.status().ToString());
+    if (expected.ok()) {
+        Check((*ours)->Equals(**expected), name + " matches DuckDB's export: " + (*ours)->Diff(**expected));
+    }
+}
+
+// Kernels that rewrite DuckDB's layout instead of copying it
+void TestTransformedKernels(duckdb::Connection& conn) {
+    CheckMatchesCData(conn, "SELECT v::DECIMAL(4, 1) FROM (VALUES ('-999.9'), ('0.5'), (NULL), ('123.4')) t(v)",
+                      "DECIMAL(4, 1) from INT16");
+    CheckMatchesCData(conn, "SELECT v::DECIMAL(9, 2) FROM (VALUES ('-1234567.89'), (NULL), ('0.01')) t(v)",
+                      "DECIMAL(9, 2) from INT32");
+    CheckMatchesCData(conn,
+                      "SELECT v::DECIMAL(18, 4) FROM (VALUES ('-12345678901234.5678'), ('1.0001'), (NULL)) t(v)",
+                      "DECIMAL(18, 4) from INT64");
+    CheckMatchesCData(conn,
+                      "SELECT v::DECIMAL(38, 10) FROM (VALUES ('-1234567890123456789012345678.0123456789'), "
+                      "('0.0000000001'), (NULL)) t(v)",
+                      "DECIMAL(38, 10) from INT128");
+    CheckMatchesCData(conn,
+                      "SELECT v::HUGEINT FROM (VALUES ('-170141183460469231731687303715884105727'), "
+                      "('18446744073709551616'), ('-1'), (NULL)) t(v)",
+                      "HUGEINT");
+    CheckMatchesCData(conn,
+                      "SELECT v::INTERVAL FROM (VALUES ('1 month 2 days 3.000004 seconds'), "
+                      "('-14 months -3 days -1 microseconds'), (NULL)) t(v)",
+                      "INTERVAL");
+    CheckMatchesCData(conn,
+                      "SELECT v::TIMESTAMPTZ FROM (VALUES ('2024-01-02 03:04:05.123456+00'), "
+                      "('1969-12-31 23:59:59.999999+00'), (NULL)) t(v)",
+                      "TIMESTAMP_TZ");
+}
+
+// DuckDB exports UUIDs as strings, so the bytes are checked directly: the
+// canonical big-endian order, on both sides of DuckDB's flipped top bit
+void TestUuidBytes(duckdb::Connection& conn) {
+    auto array = ConvertQuery(conn,
+                              "SELECT v::UUID FROM (VALUES ('00112233-4455-6677-8899-aabbccddeeff'), "
+                              "('ffeeddcc-bbaa-9988-7766-554433221100'), (NULL)) t(v)");
+    Check(array.ok(), "UUID converts: " + array.status().ToString());
+    if (!array.ok()) {
+        return;
+    }
+    auto& uuids = static_cast<const arrow::FixedSizeBinaryArray&>(**array);
+    Check(uuids.length() == 3 && uuids.IsNull(2), "UUID: 3 rows, the last null");
+    for (int64_t row = 0; row < 2 && row < uuids.length(); ++row) {
+        bool ordered = true;
+        for (int i = 0; i < 16; ++i) {
+            auto expected = static_cast<uint8_t>(row == 0 ? i * 0x11 : 0xff - i * 0x11);
+            ordered = ordered && uuids.GetValue(row)[i] == expected;
+        }
+        Check(ordered, "UUID row " + std::to_string(row) + " is in canonical byte order");
+    }
+}
+
+// Arrow has no unsigned 128-bit type: UHUGEINT becomes decimal(38, 0) as
+// long as the value fits in it
+void TestUhugeint(duckdb::Connection& conn) {
+    auto array = ConvertQuery(conn, "SELECT v::UHUGEINT FROM (VALUES ('18446744073709551621'), (NULL)) t(v)");
+    Check(array.ok(), "UHUGEINT converts: " + array.status().ToString());
+    if (array.ok()) {
+        auto& values = static_cast<const arrow::Decimal128Array&>(**array);
+        Check(values.length() == 2 && values.FormatValue(0) == "18446744073709551621" && values.IsNull(1),
+              "UHUGEINT keeps its value");
+    }
+    auto tooLarge = ConvertQuery(conn, "SELECT '340282366920938463463374607431768211455'::UHUGEINT");
+    Check(!tooLarge.ok(), "UHUGEINT above 2^127 - 1 is rejected");
+}
+
+// A sparse union has no validity bitmap, so a NULL row must come out as a
+// null in the member its type code selects
+void CheckUnionNulls(const arrow::Array& array, const std::string& name) {
+    auto& unions = static_cast<const arrow::SparseUnionArray&>(array);
+    Check(unions.length() == 3, name + ": 3 rows");
+    if (unions.length() != 3) {
+        return;
+    }
+    auto& numbers = static_cast<const arrow::Int32Array&>(*unions.field(0));
+    auto& strings = static_cast<const arrow::StringArray&>(*unions.field(1));
+    Check(unions.type_code(0) == 0 && numbers.IsValid(0) && numbers.Value(0) == 7, name + ": row 0 is num 7");
+    Check(unions.IsNull(1), name + ": NULL row reads as null");
+    Check(unions.type_code(1) == 0 && numbers.IsNull(1), name + ": NULL row selects a null num");
+    Check(unions.type_code(2) == 1 && strings.IsValid(2) && strings.GetString(2) == "x", name + ": row 2 is str 'x'");
+}
+
+void TestUnionNullFromQuery(duckdb::Connection& conn) {
+    auto array = ConvertQuery(conn,
+                              "SELECT u FROM (VALUES (1, union_value(num := 7)::UNION(num INTEGER, str VARCHAR)), "
+                              "(2, NULL), (3, union_value(str := 'x'))) t(id, u) ORDER BY id");
+    Check(array.ok(), "union query converts: " + array.status().ToString());
+    if (array.ok()) {
+        CheckUnionNulls(**array, "union query");
+    }
+}
+
+// The union row is NULL while member 0 still holds a value underneath, which
+// DuckDB does not rule out
+void TestUnionNullOverMemberValue() {
+    duckdb::child_list_t<duckdb::LogicalType> members = {{"num", duckdb::LogicalType::INTEGER},
+                                                         {"str", duckdb::LogicalType::VARCHAR}};
+    auto type = duckdb::LogicalType::UNION(members);
+    duckdb::DataChunk chunk;
+    chunk.Initialize(duckdb::Allocator::DefaultAllocator(), {type});
+    chunk.SetValue(0, 0, duckdb::Value::UNION(members, 0, duckdb::Value::INTEGER(7)));
+    chunk.SetValue(0, 1, duckdb::Value::UNION(members, 0, duckdb::Value::INTEGER(8)));
+    chunk.SetValue(0, 2, duckdb::Value::UNION(members, 1, duckdb::Value("x")));
+    chunk.SetCardinality(3);
+    duckdb::FlatVector::Validity(chunk.data[0]).SetInvalid(1);
+
+    auto array = ConvertChunk(chunk);
+    Check(array.ok(), "union chunk converts: " + array.status().ToString());
+    if (array.ok()) {
+        CheckUnionNulls(**array, "union chunk");
+    }
+}
+
+void TestConstantNullUnion(duckdb::Connection& conn) {
+    auto array = ConvertQuery(conn, "SELECT NULL::UNION(num INTEGER, str VARCHAR) AS u FROM range(3)");
+    Check(array.ok(), "constant NULL union converts: " + array.status().ToString());
+    if (array.ok()) {
+        Check((*array)->ComputeLogicalNullCount() == 3, "constant NULL union: every row is null");
+    }
+}
+
+// A row target smaller than a DataChunk splits chunks rather than being exceeded
+void TestBatchRowsSplitChunks(duckdb::Connection& conn) {
+    auto result = conn.Query("SELECT i::INTEGER AS i, i::VARCHAR AS s FROM range(5000) t(i)");
+    BatchSize batchSize;
+    batchSize.rows = 1000;
+    auto accumulator = ChunkAccumulator::Make(result->types, result->names, batchSize);
+    Check(accumulator.ok(), "accumulator with a row target: " + accumulator.status().ToString());
+    if (!accumulator.ok()) {
+        return;
+    }
+    while (auto chunk = result->Fetch()) {
+        if (chunk->size() == 0) {
+            break;
+        }
+        auto status = (*accumulator)->append(*chunk);
+        Check(status.ok(), "append with a row target: " + status.ToString());
+    }
+    auto table = (*accumulator)->finish();
+    Check(table.ok(), "finish with a row target: " + table.status().ToString());
+    if (!table.ok()) {
+        return;
+    }
+    auto& ints = *(*table)->column(0);
+    Check(ints.num_chunks() == 5, "5000 rows in batches of 1000 make 5 chunks");
+    int64_t expected = 0;
+    for (const auto& chunk : ints.chunks()) {
+        Check(chunk->length() == 1000, "every batch has exactly 1000 rows");
+        auto& values = static_cast<const arrow::Int32Array&>(*chunk);
+        for (int64_t i = 0; i < values.length(); ++i, ++expected) {
+            if (values.Value(i) != expected) {
+                Check(false, "row " + std::to_string(expected) + " keeps its value across the split");
+                return;
+            }
+        }
+    }
+}
+
+// Nested columns count towards a byte target through their child builders,
+// so a LIST/STRUCT-only result is still cut into batches
+void TestBatchBytesNestedColumns(duckdb::Connection& conn) {
+    auto result = conn.Query("SELECT [i, i + 1, i + 2]::INTEGER[] AS l, {'a': i, 'b': i::VARCHAR} AS s "
+                             "FROM range(20000) t(i)");
+    BatchSize batchSize;
+    batchSize.bytes = 64 * 1024;
+    auto accumulator = ChunkAccumulator::Make(result->types, result->names, batchSize);
+    Check(accumulator.ok(), "accumulator with a byte target: " + accumulator.status().ToString());
+    if (!accumulator.ok()) {
+        return;
+    }
+    while (auto chunk = result->Fetch()) {
+        if (chunk->size() == 0) {
+            break;
+        }
+        auto status = (*accumulator)->append(*chunk);
+        Check(status.ok(), "append with a byte target: " + status.ToString());
+    }
+    auto table = (*accumulator)->finish();
+    Check(table.ok(), "finish with a byte target: " + table.status().ToString());
+    if (!table.ok()) {
+        return;
+    }
+    Check((*table)->num_rows() == 20000, "nested batches keep every row");
+    Check((*table)->column(0)->num_chunks() > 1, "nested columns reach the byte target");
+    auto valid = (*table)->ValidateFull();
+    Check(valid.ok(), "nested batches validate: " + valid.ToString());
+}
+
+arrow::Result<std::shared_ptr<arrow::Table>> ConvertTable(
+    duckdb::Connection& conn, const std::string& query, BatchSize batchSize, bool parallel,
+    const std::unordered_set<std::string>& dictionaryColumns = std::unordered_set<std::string>()) {
+    auto result = conn.Query(query);
+    if (result->HasError()) {
+        return arrow::Status::ExecutionError(result->GetError());
+    }
+    ARROW_ASSIGN_OR_RAISE(auto accumulator,
+                          ChunkAccumulator::Make(result->types, result->names, batchSize, dictionaryColumns));
+    accumulator->setParallel(parallel);
+    while (auto chunk = result->Fetch()) {
+        if (chunk->size() == 0) {
+            break;
+        }
+        ARROW_RETURN_NOT_OK(accumulator->append(*chunk));
+    }
+    return accumulator->finish();
+}
+
+// Parallel mode converts spans of DataChunks column by column; the batches
+// must come out exactly as the serial path cuts them
+void TestParallelMatchesSerial(duckdb::Connection& conn) {
+    const std::string query = "SELECT i::INTEGER AS i, i::VARCHAR AS s, [i]::BIGINT[] AS l FROM range(50000) t(i)";
+    for (int64_t rows : {int64_t(0), int64_t(3000), int64_t(100000)}) {
+        BatchSize batchSize;
+        batchSize.rows = rows;
+        auto serial = ConvertTable(conn, query, batchSize, false);
+        auto parallel = ConvertTable(conn, query, batchSize, true);
+        auto name = "batch rows " + std::to_string(rows);
+        Check(serial.ok() && parallel.ok(), name + ": both modes convert");
+        if (!serial.ok() || !parallel.ok()) {
+            continue;
+        }
+        Check((*parallel)->column(0)->num_chunks() == (*serial)->column(0)->num_chunks(),
+              name + ": parallel mode cuts the same batches");
+        Check((*parallel)->Equals(**serial), name + ": parallel mode converts the same values");
+    }
+}
+
+const std::string kDictionaryQuery =
+    "SELECT ('v' || (i // 1500))::VARCHAR AS s, NULL::VARCHAR AS n, "
+    "(CASE WHEN i % 2 = 0 THEN 'a' ELSE 'b' END)::ENUM('a', 'b', 'c') AS e FROM range(10000) t(i)";
+
+// Batches of a dictionary column only add the values they see first, and
+// finish() hands every chunk the same merged dictionary
+void TestDictionaryAcrossBatches(duckdb::Connection& conn) {
+    BatchSize batchSize;
+    batchSize.rows = 1000;
+    auto table = ConvertTable(conn, kDictionaryQuery, batchSize, false, {"s", "n"});
+    Check(table.ok(), "dictionary columns convert: " + table.status().ToString());
+    if (!table.ok()) {
+        return;
+    }
+    auto valid = (*table)->ValidateFull();
+    Check(valid.ok(), "dictionary columns validate: " + valid.ToString());
+    if (!valid.ok()) {
+        return;
+    }
+
+    auto& strings = *(*table)->column(0);
+    auto& dictionary = *static_cast<const arrow::DictionaryArray&>(*strings.chunk(0)).dictionary();
+    Check(dictionary.length() == 7, "VARCHAR dictionary holds the 7 distinct values");
+    int64_t row = 0;
+    for (const auto& chunk : strings.chunks()) {
+        auto& array = static_cast<const arrow::DictionaryArray&>(*chunk);
+        Check(array.dictionary().get() == &dictionary, "every VARCHAR chunk shares one dictionary");
+        auto& values = static_cast<const arrow::StringArray&>(dictionary);
+        for (int64_t i = 0; i < array.length(); ++i, ++row) {
+            if (values.GetString(array.GetValueIndex(i)) != "v" + std::to_string(row / 1500)) {
+                Check(false, "VARCHAR row " + std::to_string(row) + " decodes to its value");
+                return;
+            }
+        }
+    }
+
+    auto& nulls = *(*table)->column(1);
+    Check(nulls.null_count() == nulls.length(), "an all-NULL dictionary column stays null");
+
+    auto& enums = *(*table)->column(2);
+    auto& enumValues = static_cast<const arrow::StringArray&>(
+        *static_cast<const arrow::DictionaryArray&>(*enums.chunk(0)).dictionary());
+    Check(enumValues.length() == 3 && enumValues.GetString(2) == "c", "ENUM dictionary is the enum values");
+    auto& firstEnum = static_cast<const arrow::DictionaryArray&>(*enums.chunk(0));
+    Check(firstEnum.GetValueIndex(0) == 0 && firstEnum.GetValueIndex(1) == 1, "ENUM codes are the indices");
+
+    auto plain = ConvertTable(conn, kDictionaryQuery, batchSize, false, {"n"});
+    Check(plain.ok() && (*plain)->schema()->field(0)->type()->Equals(*arrow::utf8()) &&
+              (*plain)->schema()->field(1)->type()->id() == arrow::Type::DICTIONARY,
+          "only the listed VARCHAR columns become dictionaries");
+}
+
+// A streamed batch only has the dictionary merged so far, which has to cover
+// its own indices
+void TestDictionaryStreamedBatches(duckdb::Connection& conn) {
+    auto result = conn.Query(kDictionaryQuery);
+    BatchSize batchSize;
+    batchSize.rows = 1000;
+    auto accumulator = ChunkAccumulator::Make(result->types, result->names, batchSize, {"s", "n"});
+    Check(accumulator.ok(), "streamed dictionary accumulator: " + accumulator.status().ToString());
+    if (!accumulator.ok()) {
+        return;
+    }
+    int64_t rows = 0;
+    auto takeBatches = [&]() {
+        while (true) {
+            auto batch = (*accumulator)->takeBatch();
+            Check(batch.ok(), "streamed dictionary batch: " + batch.status().ToString());
+            if (!batch.ok() || !*batch) {
+                return;
+            }
+            auto valid = (*batch)->ValidateFull();
+            Check(valid.ok(), "streamed dictionary batch validates: " + valid.ToString());
+            rows += (*batch)->num_rows();
+        }
+    };
+    while (auto chunk = result->Fetch()) {
+        if (chunk->size() == 0) {
+            break;
+        }
+        auto status = (*accumulator)->append(*chunk);
+        Check(status.ok(), "append streamed dictionary chunk: " + status.ToString());
+        takeBatches();
+    }
+    auto status = (*accumulator)->flush();
+    Check(status.ok(), "flush streamed dictionary batch: " + status.ToString());
+    takeBatches();
+    Check(rows == 10000, "streamed dictionary batches keep every row");
+}
+
+} // namespace
+
+int main() {
+    duckdb::DuckDB db(nullptr);
+    duckdb::Connection conn(db);
+
+    TestTransformedKernels(conn);
+    TestUuidBytes(conn);
+    TestUhugeint(conn);
+    TestUnionNullFromQuery(conn);
+    TestUnionNullOverMemberValue();
+    TestConstantNullUnion(conn);
+    TestBatchRowsSplitChunks(conn);
+    TestBatchBytesNestedColumns(conn);
+    TestParallelMatchesSerial(conn);
+    TestDictionaryAcrossBatches(conn);
+    TestDictionaryStreamedBatches(conn);
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include "duckdb.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Writes synthetic Parquet files with DuckDB's COPY ... TO (FORMAT PARQUET),
+// so benchmarks run on known inputs. Every value is a hash of the row
+// number, the column and --seed, so the same flags always produce the same
+// data. COPY streams from range(), which keeps memory flat at any size.
+
+struct GeneratorOptions {
+    std::string output = "synthetic.parquet";
+    int64_t rows = 1000000;
+    int columns = 8;
+    std::vector<std::string> types = {"integer", "bigint", "double", "varchar"};
+    double nullRatio = 0.0;
+    int64_t minLength = 8;
+    int64_t maxLength = 32;
+    // Distinct values per column; 0 makes every row distinct
+    int64_t cardinality = 0;
+    int64_t rowGroupSize = 122880;
+    std::string compression = "snappy";
+    int files = 1;
+    int64_t seed = 42;
+};
+
+// Value key of a row for column `col`: the row number itself, or one of
+// `cardinality` hashed buckets
+std::string KeyExpression(const GeneratorOptions& options, int col) {
+    if (options.cardinality <= 0) {
+        return "i";
+    }
+    return "(hash(i, " + std::to_string(options.seed) + ", " + std::to_string(col) + ") % " +
+           std::to_string(options.cardinality) + ")";
+}
+
+// Returns an empty string for an unknown type name
+std::string ValueExpression(const GeneratorOptions& options, const std::string& type, int col) {
+    auto key = KeyExpression(options, col);
+    if (type == "boolean") {
+        return "(" + key + " % 2 = 0)";
+    } else if (type == "integer") {
+        return "(" + key + " % 2147483647)::INTEGER";
+    } else if (type == "bigint") {
+        return key + "::BIGINT";
+    } else if (type == "double") {
+        return key + "::DOUBLE / 7";
+    } else if (type == "decimal") {
+        // Cast last: dividing a DECIMAL in DuckDB gives a DOUBLE
+        return "(((" + key + " % 10000000000) / 100)::DECIMAL(18, 2))";
+    } else if (type == "date") {
+        return "(DATE '2000-01-01' + (" + key + " % 10000)::INTEGER)";
+    } else if (type == "timestamp") {
+        return "(TIMESTAMP '2000-01-01' + to_seconds((" + key + " % 1000000000)::BIGINT))";
+    } else if (type == "varchar") {
+        // Lengths are spread uniformly over [minLength, maxLength], derived
+        // from the key so equal keys still give equal strings
+        auto span = std::to_string(options.maxLength - options.minLength + 1);
+        auto length = "(" + std::to_string(options.minLength) + " + hash(" + key + ", " +
+                      std::to_string(options.seed) + ") % " + span + ")::INTEGER";
+        return "left(repeat(md5(" + key + "::VARCHAR), " + length + " // 32 + 1), " + length + ")";
+    }
+    return "";
+}
+
+std::string SelectList(const GeneratorOptions& options) {
+    std::string select;
+    auto nullThreshold = static_cast<int64_t>(options.nullRatio * 1000000);
+    for (int col = 0; col < options.columns; ++col) {
+        const auto& type = options.types[col % options.types.size()];
+        auto value = ValueExpression(options, type, col);
+        if (nullThreshold > 0) {
+            value = "CASE WHEN hash(i, " + std::to_string(options.seed) + ", " + std::to_string(-col - 1) +
+                    ") % 1000000 < " + std::to_string(nullThreshold) + " THEN NULL ELSE " + value + " END";
+        }
+        select += (col == 0 ? "" : ", ") + value + " AS c" + std::to_string(col) + "_" + type;
+    }
+    return select;
+}
+
+// With several files the part number goes before the extension
+std::string PartPath(const std::string& output, int part, int files) {
+    if (files == 1) {
+        return output;
+    }
+    auto dot = output.rfind('.');
+    auto stem = dot == std::string::npos ? output : output.substr(0, dot);
+    auto extension = dot == std::string::npos ? std::string(".parquet") : output.substr(dot);
+    return stem + "_" + std::to_string(part) + extension;
+}
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--output=<file.parquet>] [--rows=<n>] [--columns=<n>]\n"
+              << "  [--types=<boolean,integer,bigint,double,decimal,date,timestamp,varchar>]\n"
+              << "  [--null-ratio=<0..1>] [--string-length=<min>:<max>] [--cardinality=<n>]\n"
+              << "  [--row-group-size=<rows>] [--compression=<uncompressed|snappy|gzip|zstd|lz4>]\n"
+              << "  [--files=<n>] [--seed=<n>]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    GeneratorOptions options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = arg.substr(arg.find('=') + 1);
+            if (arg.rfind("--output=", 0) == 0) {
+                options.output = value;
+            }
+            else if (arg.rfind("--rows=", 0) == 0) {
+                options.rows = std::stoll(value);
+            }
+            else if (arg.rfind("--columns=", 0) == 0) {
+                options.columns = std::stoi(value);
+            }
+            else if (arg.rfind("--types=", 0) == 0) {
+                options.types.clear();
+                std::stringstream list(value);
+                std::string type;
+                while (std::getline(list, type, ',')) {
+                    options.types.push_back(type);
+                }
+            }
+            else if (arg.rfind("--null-ratio=", 0) == 0) {
+                options.nullRatio = std::stod(value);
+            }
+            else if (arg.rfind("--string-length=", 0) == 0) {
+                auto colon = value.find(':');
+                options.minLength = std::stoll(value.substr(0, colon));
+                options.maxLength = colon == std::string::npos ? options.minLength : std::stoll(value.substr(colon + 1));
+            }
+            else if (arg.rfind("--cardinality=", 0) == 0) {
+                options.cardinality = std::stoll(value);
+            }
+            else if (arg.rfind("--row-group-size=", 0) == 0) {
+                options.rowGroupSize = std::stoll(value);
+            }
+            else if (arg.rfind("--compression=", 0) == 0) {
+                options.compression = value;
+            }
+            else if (arg.rfind("--files=", 0) == 0) {
+                options.files = std::stoi(value);
+            }
+            else if (arg.rfind("--seed=", 0) == 0) {
+                options.seed = std::stoll(value);
+            }
+            else {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid argument: " << e.what() << std::endl;
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (options.rows < 0 || options.columns <= 0 || options.types.empty() || options.files <= 0 ||
+        options.minLength < 0 || options.maxLength < options.minLength || options.rowGroupSize <= 0) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    for (const auto& type : options.types) {
+        if (ValueExpression(options, type, 0).empty()) {
+            std::cerr << "Unknown column type: " << type << std::endl;
+            return 1;
+        }
+    }
+
+    duckdb::DuckDB db(nullptr);
+    duckdb::Connection conn(db);
+    auto select = SelectList(options);
+    for (int part = 0; part < options.files; ++part) {
+        // Rows are split evenly over the files, the first ones taking the rest
+        auto begin = options.rows / options.files * part + std::min<int64_t>(part, options.rows % options.files);
+        auto end = begin + options.rows / options.files + (part < options.rows % options.files ? 1 : 0);
+        auto path = PartPath(options.output, part, options.files);
+        auto query = "COPY (SELECT " + select + " FROM range(" + std::to_string(begin) + ", " + std::to_string(end) +
+                     ") t(i)) TO " + duckdb::Value(path).ToSQLString() + " (FORMAT PARQUET, COMPRESSION " +
+                     options.compression + ", ROW_GROUP_SIZE " + std::to_string(options.rowGroupSize) + ")";
+        auto result = conn.Query(query);
+        if (result->HasError()) {
+            std::cerr << "Failed to write " << path << ": " << result->GetError() << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << (end - begin) << " rows to " << path << std::endl;
+    }
+    return 0;
+}